@@ -0,0 +1,116 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "baseline.h"
+
+#define BASELINE_MAX_ROWS 256
+
+// Writes rows to path. Returns 0 on success, -1 if it cannot be written.
+int baseline_save(const char *path, const BenchRowType rows[], int nrows, unsigned long long seed)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL)
+        return -1;
+    fprintf(f, "# schedbench baseline, seed %llu\n", seed);
+    fprintf(f, "# sched n reps mean_proc_per_s sd allocs peak_rss_kb\n");
+    for (int i = 0; i < nrows; i++) {
+        const BenchRowType *r = &rows[i];
+        fprintf(f, "%s %ld %d %.6e %.6e %ld %ld\n", r->name, r->n, r->reps, r->mean, r->sd,
+                r->allocs, r->rss_kb);
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+static int load(FILE *f, BenchRowType rows[], unsigned long long *seed)
+{
+    char line[256];
+    int n = 0;
+
+    *seed = 0;
+    while (n < BASELINE_MAX_ROWS && fgets(line, sizeof(line), f) != NULL) {
+        BenchRowType *r = &rows[n];
+
+        if (line[0] == '#') {
+            sscanf(line, "# schedbench baseline, seed %llu", seed);
+            continue;
+        }
+        if (sscanf(line, "%15s %ld %d %lf %lf %ld %ld", r->name, &r->n, &r->reps, &r->mean, &r->sd,
+                   &r->allocs, &r->rss_kb) == 7)
+            n++;
+    }
+    return n;
+}
+
+// Welch's t statistic of a drop from base to now, positive when slower
+static double welch_t(const BenchRowType *base, const BenchRowType *now)
+{
+    double se = sqrt(base->sd * base->sd / base->reps + now->sd * now->sd / now->reps);
+
+    if (se == 0)
+        return base->mean > now->mean ? INFINITY : 0;
+    return (base->mean - now->mean) / se;
+}
+
+/**
+ * Checks rows against the baseline in path and prints one line per
+ * row. Returns the number of regressions, or -1 if the baseline cannot
+ * be read or was taken with another seed, i.e. on other workloads.
+ */
+int baseline_compare(const char *path, const BenchRowType rows[], int nrows,
+                     unsigned long long seed, double tolerance)
+{
+    static BenchRowType base[BASELINE_MAX_ROWS];
+    unsigned long long base_seed;
+    FILE *f = fopen(path, "r");
+    int nbase, regressions = 0;
+
+    if (f == NULL) {
+        printf("Error: Could not open baseline %s\n", path);
+        return -1;
+    }
+    nbase = load(f, base, &base_seed);
+    fclose(f);
+    if (base_seed != seed) {
+        printf("Error: Baseline %s was taken with seed %llu, not %llu\n", path, base_seed, seed);
+        return -1;
+    }
+
+    printf("\n%-9s %10s %12s %12s %8s %7s %15s %17s  %s\n", "sched", "n", "base Mp/s", "now Mp/s",
+           "change", "t", "allocs", "peak RSS kB", "verdict");
+    for (int i = 0; i < nrows; i++) {
+        const BenchRowType *now = &rows[i], *b = NULL;
+        const char *verdict = "ok";
+
+        for (int j = 0; j < nbase && b == NULL; j++) {
+            if (strcmp(base[j].name, now->name) == 0 && base[j].n == now->n)
+                b = &base[j];
+        }
+        if (b == NULL) {
+            printf("%-9s %10ld %12s %12.3f %8s %7s %15ld %17ld  new\n", now->name, now->n, "-",
+                   now->mean / 1e6, "-", "-", now->allocs, now->rss_kb);
+            continue;
+        }
+
+        double change = b->mean > 0 ? now->mean / b->mean - 1 : 0;
+        double t = welch_t(b, now);
+        if (change < -tolerance && t > BASELINE_T_CRIT)
+            verdict = "SLOWER";
+        else if (now->allocs > b->allocs)
+            verdict = "MORE ALLOCS";
+        else if (now->rss_kb >= 0 && b->rss_kb >= 0
+                 && now->rss_kb > b->rss_kb * (1 + tolerance) + BASELINE_RSS_SLACK_KB)
+            verdict = "MORE MEMORY";
+        if (strcmp(verdict, "ok") != 0)
+            regressions++;
+
+        char allocs[32], rss[32];
+        snprintf(allocs, sizeof(allocs), "%ld/%ld", b->allocs, now->allocs);
+        snprintf(rss, sizeof(rss), "%ld/%ld", b->rss_kb, now->rss_kb);
+        printf("%-9s %10ld %12.3f %12.3f %+7.1f%% %7.1f %15s %17s  %s\n", now->name, now->n,
+               b->mean / 1e6, now->mean / 1e6, change * 100, isinf(t) ? 99.9 : t, allocs, rss,
+               verdict);
+    }
+    return regressions;
+}
@@ -0,0 +1,31 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+/**
+ * Stored benchmark baselines and the regression gate over them. A row
+ * is one scheduler at one input size: throughput over reps samples,
+ * allocator calls per run and peak RSS. Throughput counts as regressed
+ * only when it is both more than tolerance below the baseline and the
+ * drop is significant by Welch's t-test at BASELINE_T_CRIT, so run to
+ * run noise on a busy machine does not fail the gate. Allocation
+ * counts are deterministic and may not grow at all; peak RSS may grow
+ * by tolerance plus BASELINE_RSS_SLACK_KB.
+ */
+
+#define BASELINE_T_CRIT 3.0
+#define BASELINE_RSS_SLACK_KB 1024
+
+typedef struct BenchRow {
+    char name[16];
+    long n;
+    int reps;
+    double mean;		// processes per second
+    double sd;
+    long allocs;
+    long rss_kb;		// -1 when unknown
+} BenchRowType;
+
+int baseline_save(const char *, const BenchRowType[], int, unsigned long long);
+int baseline_compare(const char *, const BenchRowType[], int, unsigned long long, double);
+
+#endif				// BASELINE_H
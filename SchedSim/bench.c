@@ -0,0 +1,671 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+#include "baseline.h"
+#include "engine.h"
+#include "mem.h"
+#include "metrics.h"
+#include "process.h"
+#include "radix.h"
+#include "rng.h"
+#include "sched.h"
+#include "source.h"
+
+/**
+ * Sorting benchmark: the radix sort against the qsort_r index sorts it
+ * replaced, on key columns shaped like the ones the schedulers sort.
+ * Every radix result is checked against qsort before it is timed.
+ *
+ * Engine benchmark: every policy replayed reps times over one work
+ * area, counting every allocator call made during engine_run(), in the
+ * engine, metrics or source alike. Only the first run may allocate;
+ * any allocation after it fails the benchmark.
+ *
+ * Table benchmark: a process table walked in a random dispatch order,
+ * as the schedulers walk it through order[], once per huge page mode,
+ * with dTLB load misses when the CPU exposes them.
+ *
+ * Scheduler benchmark: each findWaitingTime* pass per input size, with
+ * cycles, instructions, cache, branch and dTLB misses read through
+ * perf_event_open, so a slow scheduler shows why it is slow. Where
+ * counters cannot be opened their columns read n/a.
+ *
+ * With -B or -R only the scheduler benchmark runs, from a fresh seed,
+ * and its rows, with allocator calls and peak RSS, are saved as a
+ * baseline or checked against one; see baseline.h. Allocator calls are
+ * counted by wrapping malloc, calloc and realloc at link time.
+ */
+
+static long alloc_calls;
+
+void *__real_malloc(size_t);
+void *__real_calloc(size_t, size_t);
+void *__real_realloc(void *, size_t);
+
+void *__wrap_malloc(size_t size)
+{
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size)
+{
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    return __real_realloc(p, size);
+}
+
+// Restarts the peak RSS count; returns false where the kernel refuses
+static bool reset_peak_rss(void)
+{
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+
+    if (f == NULL)
+        return false;
+    bool ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+// VmHWM in kB, or -1
+static long peak_rss_kb(void)
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+
+    if (f == NULL)
+        return -1;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+            break;
+    }
+    fclose(f);
+    return kb;
+}
+
+typedef enum KeyShape {
+    KEYS_UNIFORM,			// full 64-bit range
+    KEYS_PRIORITY,			// 16 values, descending as in the Priority path
+    KEYS_ARRIVAL,			// non-decreasing with random gaps, lightly shuffled
+    NUM_KEY_SHAPES
+} KeyShapeType;
+
+static const char *shape_names[NUM_KEY_SHAPES] = { "uniform", "priority", "arrival" };
+
+// Baseline comparator: ascending key, ties on index, i.e. a stable sort
+static int key_comparer(const void *this, const void *that, void *arg)
+{
+    const uint64_t *keys = (const uint64_t *) arg;
+    int i1 = *(const int *) this;
+    int i2 = *(const int *) that;
+
+    if (keys[i1] != keys[i2])
+        return keys[i1] < keys[i2] ? -1 : 1;
+    return i1 - i2;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void make_keys(uint64_t keys[], int n, KeyShapeType shape, RngType *rng)
+{
+    int art = 0;
+
+    for (int i = 0; i < n; i++) {
+        switch (shape) {
+        case KEYS_UNIFORM:
+            keys[i] = (uint64_t) rng_next(rng);
+            break;
+        case KEYS_PRIORITY:
+            keys[i] = RADIX_KEY_DESC((int) (rng_next(rng) % 16));
+            break;
+        default:
+            art += (int) (rng_next(rng) % 8);
+            keys[i] = RADIX_KEY(art);
+            break;
+        }
+    }
+    // Arrival traces from several hosts are only nearly sorted
+    if (shape == KEYS_ARRIVAL) {
+        for (int i = 0; i < n / 100; i++) {
+            int a = (int) (rng_next(rng) % n), b = (int) (rng_next(rng) % n);
+            uint64_t t = keys[a];
+            keys[a] = keys[b];
+            keys[b] = t;
+        }
+    }
+}
+
+static void identity(int order[], int n)
+{
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+}
+
+// Best of reps wall times, in milliseconds
+static double time_qsort(const uint64_t keys[], int order[], int n, int reps)
+{
+    double best = 1e300;
+
+    for (int r = 0; r < reps; r++) {
+        identity(order, n);
+        double t = now();
+        qsort_r(order, n, sizeof(int), key_comparer, (void *) keys);
+        t = now() - t;
+        if (t < best)
+            best = t;
+    }
+    return best * 1e3;
+}
+
+static double time_radix(const uint64_t keys[], int order[], int n, int reps, int threads)
+{
+    double best = 1e300;
+
+    for (int r = 0; r < reps; r++) {
+        identity(order, n);
+        double t = now();
+        radix_sort_index(keys, order, n, threads);
+        t = now() - t;
+        if (t < best)
+            best = t;
+    }
+    return best * 1e3;
+}
+
+// Poisson arrivals at about 90% load, exponential bursts
+static void make_workload(ProcessType plist[], int order[], int n, RngType *rng)
+{
+    long art = 0;
+
+    for (int i = 0; i < n; i++) {
+        art += lround(rng_exp(rng, 10.0));
+        plist[i].pid = i + 1;
+        plist[i].art = art;
+        plist[i].bt = 1 + lround(rng_exp(rng, 8.0));
+        plist[i].pri = (int) (rng_next(rng) % 16);
+        plist[i].tenant = 0;
+        order[i] = i;
+    }
+}
+
+static int bench_engine(int n, int reps, RngType *rng)
+{
+    ProcessType *plist = (ProcessType *) malloc(n * sizeof(ProcessType));
+    int *order = (int *) malloc(n * sizeof(int));
+    MetricsType *m = (MetricsType *) malloc(sizeof(MetricsType));
+    EngineWorkType work;
+    int status = 0;
+
+    make_workload(plist, order, n, rng);
+    engine_work_init(&work);
+    printf("\n%-9s %10s %12s %14s %14s %12s\n", "policy", "n", "best ms", "first mallocs",
+           "steady mallocs", "peak slots");
+    for (int p = POLICY_FCFS; p <= POLICY_RR; p++) {
+        EngineType e = { (PolicyType) p, 2, NULL, &work };
+        long first = 0, steady = 0;
+        double best = 1e300;
+
+        for (int r = 0; r < reps; r++) {
+            SourceType src;
+            ArraySourceType array;
+            long calls;
+
+            array_source_init(&src, &array, plist, order, n);
+            calls = alloc_calls;
+            double t = now();
+            engine_run(&e, &src, m);
+            t = now() - t;
+            calls = alloc_calls - calls;
+            if (t < best)
+                best = t;
+            if (r == 0)
+                first = calls;
+            else
+                steady += calls;
+        }
+        printf("%-9s %10d %12.3f %14ld %14ld %12ld\n", engine_policy_name(e.policy), n,
+               best * 1e3, first, steady, work.slots.stats.peak);
+        if (steady != 0)
+            status = 1;
+    }
+    if (status != 0)
+        printf("Error: The engine allocated after its first run\n");
+
+    engine_work_free(&work);
+    free(plist);
+    free(order);
+    free(m);
+    return status;
+}
+
+typedef enum Counter {
+    CTR_CYCLES,
+    CTR_INSTRUCTIONS,
+    CTR_CACHE_MISSES,
+    CTR_BRANCH_MISSES,
+    CTR_DTLB_MISSES,
+    NUM_COUNTERS
+} CounterType;
+
+// Hardware counters of this thread; fd is -1 for counters the CPU,
+// kernel or perf_event_paranoid do not allow, and value is then -1
+typedef struct Counters {
+    int fd[NUM_COUNTERS];
+    long value[NUM_COUNTERS];
+} CountersType;
+
+static void counters_open(CountersType *c)
+{
+    static const uint32_t types[NUM_COUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE
+    };
+    static const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+    };
+    struct perf_event_attr attr;
+
+    for (int k = 0; k < NUM_COUNTERS; k++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[k];
+        attr.config = configs[k];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Counters are multiplexed when there are more than the PMU has
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        c->fd[k] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        c->value[k] = -1;
+    }
+}
+
+static bool counters_any(const CountersType *c)
+{
+    for (int k = 0; k < NUM_COUNTERS; k++) {
+        if (c->fd[k] >= 0)
+            return true;
+    }
+    return false;
+}
+
+static void counters_start(CountersType *c)
+{
+    for (int k = 0; k < NUM_COUNTERS; k++) {
+        if (c->fd[k] >= 0) {
+            ioctl(c->fd[k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[k], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+// Reads every counter, scaled up for the time it was multiplexed out
+static void counters_stop(CountersType *c)
+{
+    for (int k = 0; k < NUM_COUNTERS; k++) {
+        uint64_t v[3];
+
+        c->value[k] = -1;
+        if (c->fd[k] < 0)
+            continue;
+        ioctl(c->fd[k], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(c->fd[k], v, sizeof(v)) != sizeof(v) || v[2] == 0)
+            continue;
+        c->value[k] = (long) ((double) v[0] * v[1] / v[2]);
+    }
+}
+
+static void counters_close(CountersType *c)
+{
+    for (int k = 0; k < NUM_COUNTERS; k++) {
+        if (c->fd[k] >= 0)
+            close(c->fd[k]);
+    }
+}
+
+// Prints value in a column of width w, or n/a when it was not counted
+static void print_count(long value, int w)
+{
+    if (value >= 0)
+        printf(" %*ld", w, value);
+    else
+        printf(" %*s", w, "n/a");
+}
+
+// AnonHugePages of this process in kB, i.e. what THP actually backs
+static long anon_huge_kb(void)
+{
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    char line[256];
+    long kb = -1;
+
+    if (f == NULL)
+        return -1;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1)
+            break;
+    }
+    fclose(f);
+    return kb;
+}
+
+static int bench_tables(int n, int reps, RngType *rng, CountersType *c)
+{
+    static const char *mode_names[] = { "off", "thp", "explicit" };
+    int *order = (int *) malloc(n * sizeof(int));
+
+    // Random dispatch order, Fisher-Yates
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int) (rng_next(rng) % (i + 1));
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    printf("\n%-9s %10s %12s %12s %14s\n", "pages", "n", "best ms", "huge MB", "dTLB misses");
+    for (int mode = HUGE_OFF; mode <= HUGE_EXPLICIT; mode++) {
+        long base_kb = anon_huge_kb(), misses = -1;
+        double best = 1e300;
+
+        mem_set_huge((HugeModeType) mode);
+        ProcessType *plist = (ProcessType *) mem_alloc((size_t) n * sizeof(ProcessType));
+        for (int i = 0; i < n; i++)
+            plist[i].bt = 1 + i % 7;
+        long huge_kb = anon_huge_kb() - base_kb;
+
+        for (int r = 0; r < reps; r++) {
+            long wt = 0;
+
+            counters_start(c);
+            double t = now();
+            for (int i = 0; i < n; i++) {
+                ProcessType *p = &plist[order[i]];
+                p->wt = wt;
+                wt += p->bt;
+            }
+            t = now() - t;
+            counters_stop(c);
+            if (t < best) {
+                best = t;
+                misses = c->value[CTR_DTLB_MISSES];
+            }
+        }
+
+        printf("%-9s %10d %12.3f %12.1f", mode_names[mode], n, best * 1e3,
+               huge_kb > 0 ? huge_kb / 1024.0 : 0.0);
+        print_count(misses, 14);
+        printf("\n");
+        mem_free(plist);
+    }
+    if (mem_huge_fallbacks() > 0)
+        printf("Explicit huge pages unavailable, fell back to transparent ones\n");
+    mem_set_huge(HUGE_OFF);
+
+    free(order);
+    return 0;
+}
+
+static const char *sched_names[] = { "FCFS", "Priority", "SJF", "RR" };
+
+// Four schedulers at sizes 10^3 up to 10^6
+#define BENCH_MAX_ROWS 16
+
+// Runs the waiting time pass of scheduler s
+static void run_sched(int s, ProcessType work[], const int order[], int n)
+{
+    switch (s) {
+    case 0:
+        findWaitingTimeFCFS(work, NULL, n);
+        break;
+    case 1:
+        findWaitingTimeFCFS(work, order, n);
+        break;
+    case 2:
+        findWaitingTimeSJF(work, n);
+        break;
+    default:
+        findWaitingTimeRR(work, n, 2);
+        break;
+    }
+}
+
+/**
+ * Times each findWaitingTime* call and reads the counters around it,
+ * keeping those of the fastest repetition. The copy of the input is
+ * made outside the counted region, and Priority's order is sorted once
+ * up front, so only the scheduling pass itself is measured. Each size
+ * also gives a row of throughput samples, allocator calls and peak RSS.
+ */
+static int bench_sched(int max_n, int reps, RngType *rng, CountersType *c, BenchRowType rows[],
+                       int *nrows)
+{
+    ProcessType *plist = (ProcessType *) malloc(max_n * sizeof(ProcessType));
+    ProcessType *work = (ProcessType *) malloc(max_n * sizeof(ProcessType));
+    int *order = (int *) malloc(max_n * sizeof(int));
+    uint64_t *keys = (uint64_t *) malloc(max_n * sizeof(uint64_t));
+
+    bool rss = true;
+
+    *nrows = 0;
+    printf("\n%-9s %10s %12s %14s %14s %6s %12s %12s %12s\n", "sched", "n", "best ms", "cycles",
+           "instructions", "IPC", "cache miss", "branch miss", "dTLB miss");
+    for (int s = 0; s < 4; s++) {
+        for (long n = 1000; n <= max_n; n *= 10) {
+            BenchRowType *row = &rows[(*nrows)++];
+            long best_ctr[NUM_COUNTERS];
+            double best = 1e300, sum = 0, sumsq = 0;
+
+            for (int k = 0; k < NUM_COUNTERS; k++)
+                best_ctr[k] = -1;
+            make_workload(plist, order, (int) n, rng);
+            for (int i = 0; i < n; i++)
+                keys[i] = RADIX_KEY_DESC(plist[i].pri);
+            radix_sort_index(keys, order, (int) n, 0);
+
+            // Peak RSS is only meaningful per row where it can be reset
+            rss = rss && reset_peak_rss();
+            for (int r = 0; r < reps; r++) {
+                memcpy(work, plist, n * sizeof(ProcessType));
+                long calls = alloc_calls;
+                counters_start(c);
+                double t = now();
+                run_sched(s, work, order, (int) n);
+                t = now() - t;
+                counters_stop(c);
+                row->allocs = alloc_calls - calls;
+                sum += n / t;
+                sumsq += (n / t) * (n / t);
+                if (t < best) {
+                    best = t;
+                    memcpy(best_ctr, c->value, sizeof(best_ctr));
+                }
+            }
+
+            printf("%-9s %10ld %12.3f", sched_names[s], n, best * 1e3);
+            print_count(best_ctr[CTR_CYCLES], 14);
+            print_count(best_ctr[CTR_INSTRUCTIONS], 14);
+            if (best_ctr[CTR_CYCLES] > 0 && best_ctr[CTR_INSTRUCTIONS] >= 0)
+                printf(" %6.2f", (double) best_ctr[CTR_INSTRUCTIONS] / best_ctr[CTR_CYCLES]);
+            else
+                printf(" %6s", "n/a");
+            print_count(best_ctr[CTR_CACHE_MISSES], 12);
+            print_count(best_ctr[CTR_BRANCH_MISSES], 12);
+            print_count(best_ctr[CTR_DTLB_MISSES], 12);
+            printf("\n");
+
+            snprintf(row->name, sizeof(row->name), "%s", sched_names[s]);
+            row->n = n;
+            row->reps = reps;
+            row->mean = sum / reps;
+            row->sd = reps > 1 ? sqrt(fmax(0, (sumsq - sum * sum / reps) / (reps - 1))) : 0;
+            row->rss_kb = rss ? peak_rss_kb() : -1;
+        }
+    }
+
+    free(plist);
+    free(work);
+    free(order);
+    free(keys);
+    return 0;
+}
+
+// Saves or checks a baseline of the scheduler benchmark; returns the exit status
+static int gate(int max_n, int reps, unsigned long long seed, const char *save_path,
+                const char *compare_path, double tolerance)
+{
+    BenchRowType rows[BENCH_MAX_ROWS];
+    CountersType counters;
+    RngType rng;
+    int nrows, status = 0;
+
+    rng_seed(&rng, seed);
+    counters_open(&counters);
+    bench_sched(max_n, reps, &rng, &counters, rows, &nrows);
+    counters_close(&counters);
+
+    if (save_path != NULL) {
+        if (baseline_save(save_path, rows, nrows, seed) != 0) {
+            printf("Error: Could not write baseline %s\n", save_path);
+            return 1;
+        }
+        printf("\nSaved %d rows to %s\n", nrows, save_path);
+        return 0;
+    }
+
+    int regressions = baseline_compare(compare_path, rows, nrows, seed, tolerance);
+    if (regressions < 0)
+        return 1;
+    if (regressions > 0) {
+        printf("Error: %d regressions against %s\n", regressions, compare_path);
+        status = 1;
+    }
+    return status;
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [-n max_count] [-j threads] [-r repetitions] [-s seed]\n"
+           "          [-B baseline_out | -R baseline_in [-T tolerance_pct]]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    long max_n = 10000000;
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int reps = 3;
+    unsigned long long seed = 1;
+    const char *save_path = NULL, *compare_path = NULL;
+    double tolerance = 0.05;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:j:r:s:B:R:T:")) != -1) {
+        switch (opt) {
+        case 'n':
+            max_n = atol(optarg);
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'B':
+            save_path = optarg;
+            break;
+        case 'R':
+            compare_path = optarg;
+            break;
+        case 'T':
+            tolerance = atof(optarg) / 100;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (max_n < 1 || max_n > 1000000000 || threads < 1 || reps < 1 || tolerance < 0
+        || (save_path != NULL && compare_path != NULL)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (save_path != NULL || compare_path != NULL)
+        return gate(max_n < 1000000 ? (int) max_n : 1000000, reps, seed, save_path, compare_path,
+                    tolerance);
+
+    uint64_t *keys = (uint64_t *) malloc(max_n * sizeof(uint64_t));
+    int *expect = (int *) malloc(max_n * sizeof(int));
+    int *order = (int *) malloc(max_n * sizeof(int));
+    RngType rng;
+    int status = 0;
+
+    rng_seed(&rng, seed);
+    printf("%-9s %10s %12s %12s %12s %9s\n", "keys", "n", "qsort ms", "radix ms", "radix -j ms", "speedup");
+    for (int s = 0; s < NUM_KEY_SHAPES && status == 0; s++) {
+        for (long n = 1000; n <= max_n; n *= 10) {
+            make_keys(keys, (int) n, (KeyShapeType) s, &rng);
+
+            double q = time_qsort(keys, expect, (int) n, reps);
+            double r1 = time_radix(keys, order, (int) n, reps, 1);
+            if (memcmp(order, expect, n * sizeof(int)) != 0)
+                status = 1;
+            double rj = time_radix(keys, order, (int) n, reps, threads);
+            if (memcmp(order, expect, n * sizeof(int)) != 0)
+                status = 1;
+
+            double best = r1 < rj ? r1 : rj;
+            printf("%-9s %10ld %12.3f %12.3f %12.3f %8.1fx\n", shape_names[s], n, q, r1, rj,
+                   best > 0 ? q / best : 0.0);
+            if (status != 0) {
+                printf("Error: Radix sort disagrees with qsort on %s keys, n = %ld\n", shape_names[s], n);
+                break;
+            }
+        }
+    }
+
+    if (status == 0)
+        status = bench_engine(max_n < 1000000 ? (int) max_n : 1000000, reps, &rng);
+    CountersType counters;
+    counters_open(&counters);
+    if (!counters_any(&counters))
+        printf("\nHardware counters unavailable (no PMU, or perf_event_paranoid too high); timing only\n");
+    BenchRowType rows[BENCH_MAX_ROWS];
+    int nrows;
+    if (status == 0)
+        status = bench_sched(max_n < 1000000 ? (int) max_n : 1000000, reps, &rng, &counters, rows,
+                             &nrows);
+    if (status == 0)
+        status = bench_tables((int) max_n, reps, &rng, &counters);
+    counters_close(&counters);
+
+    free(keys);
+    free(expect);
+    free(order);
+    return status;
+}
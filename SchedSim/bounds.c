@@ -0,0 +1,177 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bounds.h"
+#include "compare.h"
+#include "heap.h"
+#include "process.h"
+#include "util.h"
+
+/**
+ * Total flow time of preemptive SRPT on one CPU running speed times
+ * faster. Time is scaled by speed so everything stays integral: a
+ * burst of bt takes bt scaled units, an arrival at art happens at
+ * art * speed. For speed 1 this is exactly findWaitingTimeSJF.
+ */
+static double srpt_total_flow(const ProcessType plist[], const int order[], int n, long speed)
+{
+    HeapType ready;
+    int next = 0, complete = 0;
+    long t = 0;
+    double flow = 0;
+
+    heap_init(&ready, n);
+    while (complete < n) {
+        if (ready.size == 0 && plist[order[next]].art * speed > t)
+            t = plist[order[next]].art * speed;
+        while (next < n && plist[order[next]].art * speed <= t) {
+            heap_push(&ready, plist[order[next]].bt, order[next]);
+            next++;
+        }
+
+        HeapNodeType top = heap_pop(&ready);
+        long arrival = next < n ? plist[order[next]].art * speed : -1;
+
+        if (next == n || t + top.key <= arrival) {
+            t += top.key;
+            flow += t - plist[top.idx].art * speed;
+            complete++;
+        } else {
+            heap_push(&ready, top.key - (arrival - t), top.idx);
+            t = arrival;
+        }
+    }
+    heap_free(&ready);
+    return flow / speed;
+}
+
+// Highest weight / burst ratio first, compared exactly by cross multiplication
+static int wspt_comparer(const void *this, const void *that, void *arg)
+{
+    const ProcessType *plist = (const ProcessType *) arg;
+    const ProcessType *p1 = &plist[*(const int *) this];
+    const ProcessType *p2 = &plist[*(const int *) that];
+    long long lhs = (long long) (p1->pri + 1) * p2->bt;
+    long long rhs = (long long) (p2->pri + 1) * p1->bt;
+
+    if (lhs != rhs)
+        return lhs > rhs ? -1 : 1;
+    return *(const int *) this - *(const int *) that;
+}
+
+/**
+ * Lower bound on total weighted flow on one CPU from the mean busy
+ * time LP relaxation (Goemans). The LP optimum is attained by the
+ * preemptive schedule that always runs the available job with the
+ * largest w/bt, and for any feasible schedule C_j >= M_j + bt_j/2
+ * where M_j is the mean of the instants job j is running. The bound is
+ * sum w_j (M_j + bt_j/2 - art_j) over that preemptive WSPT schedule.
+ */
+static double weighted_flow_bound(const ProcessType plist[], const int order[], int n)
+{
+    int *by_ratio = (int *) malloc(n * sizeof(int));
+    int *rank = (int *) malloc(n * sizeof(int));
+    long *rem = (long *) malloc(n * sizeof(long));
+    double *busy = (double *) calloc(n, sizeof(double));	// integral of t while running
+    HeapType ready;
+    int next = 0, complete = 0;
+    long t = 0;
+    double bound = 0;
+
+    for (int i = 0; i < n; i++) {
+        by_ratio[i] = i;
+        rem[i] = plist[i].bt;
+    }
+    qsort_r(by_ratio, n, sizeof(int), wspt_comparer, (void *) plist);
+    for (int i = 0; i < n; i++)
+        rank[by_ratio[i]] = i;
+
+    heap_init(&ready, n);
+    while (complete < n) {
+        if (ready.size == 0 && plist[order[next]].art > t)
+            t = plist[order[next]].art;
+        while (next < n && plist[order[next]].art <= t) {
+            heap_push(&ready, rank[order[next]], order[next]);
+            next++;
+        }
+
+        int j = heap_pop(&ready).idx;
+        long run = rem[j];
+        if (next < n && t + run > plist[order[next]].art)
+            run = plist[order[next]].art - t;
+
+        busy[j] += (double) run * (t + run / 2.0);
+        rem[j] -= run;
+        t += run;
+        if (rem[j] == 0) {
+            double w = plist[j].pri + 1;
+            double bt = plist[j].bt;
+            double mean_busy = bt > 0 ? busy[j] / bt : t;
+            bound += w * (mean_busy + bt / 2 - plist[j].art);
+            complete++;
+        } else {
+            heap_push(&ready, rank[j], j);
+        }
+    }
+
+    heap_free(&ready);
+    free(by_ratio);
+    free(rank);
+    free(rem);
+    free(busy);
+    return bound;
+}
+
+void bounds_compute(const ProcessType plist[], int n, int cpus, BoundsType *b)
+{
+    int *order = (int *) malloc(n * sizeof(int));
+    double total_bt = 0;
+
+    sort_by_arrival(plist, n, order);
+    for (int i = 0; i < n; i++)
+        total_bt += plist[i].bt;
+
+    b->cpus = cpus;
+    b->srpt_flow = srpt_total_flow(plist, order, n, 1);
+
+    // A single CPU that is cpus times faster can mimic any cpus-CPU
+    // schedule, and no process finishes sooner than its own burst
+    b->multi_flow = total_bt;
+    if (cpus > 1) {
+        double fast = srpt_total_flow(plist, order, n, cpus);
+        if (fast > b->multi_flow)
+            b->multi_flow = fast;
+    }
+
+    b->weighted_flow = weighted_flow_bound(plist, order, n);
+    free(order);
+}
+
+static double gap(double value, double bound)
+{
+    return bound > 0 ? 100 * (value - bound) / bound : 0.0;
+}
+
+/**
+ * Prints the bounds and every policy's gap to them. The SRPT gap is
+ * exact; the weighted gap is an upper bound on the true gap.
+ */
+void bounds_print(const BoundsType *b, const PolicyResultType res[], int npol)
+{
+    int n = res[0].m->n;
+
+    printf("\n*********\nBounds\n");
+    printf("Optimal mean flow time (SRPT, 1 CPU) = %.2f\n", b->srpt_flow / n);
+    printf("Lower bound on mean weighted flow time (1 CPU, w = pri + 1) = %.2f\n", b->weighted_flow / n);
+    if (b->cpus > 1)
+        printf("Lower bound on mean flow time (%d CPUs) = %.2f\n", b->cpus, b->multi_flow / n);
+
+    printf("\tPolicy\tMean flow\tGap to optimum\tMean weighted flow\tGap to bound\n");
+    for (int k = 0; k < npol; k++) {
+        const MetricsType *m = res[k].m;
+        printf("\t%s\t%.2f\t\t%+.1f%%\t\t%.2f\t\t\t%+.1f%%\n", res[k].name,
+               (double) m->total_tat / n, gap(m->total_tat, b->srpt_flow),
+               (double) m->total_weighted_tat / n, gap(m->total_weighted_tat, b->weighted_flow));
+    }
+}
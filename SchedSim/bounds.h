@@ -0,0 +1,25 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "process.h"
+#include "compare.h"
+
+/**
+ * Offline optimum and lower bounds on schedule quality, used to report
+ * how far each policy is from the best possible schedule.
+ *
+ * Flow time is turnaround time (completion - arrival). Weighted
+ * variants use w = pri + 1, so higher priority weighs more.
+ */
+
+typedef struct Bounds {
+    int cpus;
+    double srpt_flow;		// optimal total flow on one CPU (SRPT)
+    double multi_flow;		// lower bound on total flow on cpus CPUs
+    double weighted_flow;	// lower bound on total weighted flow on one CPU
+} BoundsType;
+
+void bounds_compute(const ProcessType[], int, int, BoundsType *);
+void bounds_print(const BoundsType *, const PolicyResultType[], int);
+
+#endif				// BOUNDS_H
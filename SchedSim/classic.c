@@ -0,0 +1,247 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "heap.h"
+#include "mem.h"
+#include "metrics.h"
+#include "process.h"
+#include "radix.h"
+#include "sched.h"
+#include "util.h"
+
+// Function to find waiting time for all processes (FCFS with arrival time)
+// Processes are served in the given order, or input order if order is NULL
+void findWaitingTimeFCFS(ProcessType plist[], const int order[], int n) {
+    // Off the stack, which large tables would overflow
+    SimTimeType *service_time = (SimTimeType *)mem_alloc(n * sizeof(SimTimeType));
+    int first = order ? order[0] : 0;
+    
+    service_time[0] = plist[first].art;
+    plist[first].wt = 0;
+    plist[first].rt = 0;
+    
+    for (int i = 1; i < n; i++) {
+        int prev = order ? order[i-1] : i-1;
+        int curr = order ? order[i] : i;
+        
+        service_time[i] = service_time[i-1] + plist[prev].bt;
+        
+        if (service_time[i] < plist[curr].art) {
+            service_time[i] = plist[curr].art;
+        }
+        
+        plist[curr].wt = service_time[i] - plist[curr].art;
+        
+        if (plist[curr].wt < 0) {
+            plist[curr].wt = 0;
+        }
+        
+        // Non-preemptive: first dispatch is the only dispatch
+        plist[curr].rt = plist[curr].wt;
+    }
+    mem_free(service_time);
+}
+
+// Function to find turnaround time for all processes
+// Fairness metrics are accumulated in the same pass
+void findTurnAroundTime(ProcessType plist[], int n, MetricsType *m) {
+    metrics_init(m);
+    for (int i = 0; i < n; i++) {
+        plist[i].tat = plist[i].bt + plist[i].wt;
+        metrics_add(m, &plist[i]);
+    }
+}
+
+// Function to find waiting time for SJF (SRTF - Preemptive)
+// Event driven: the running process only changes at arrivals and
+// completions, so each step runs the shortest remaining process up to
+// the next arrival instead of advancing one time unit at a time
+void findWaitingTimeSJF(ProcessType plist[], int n) {
+    int *order = (int *)mem_alloc(n * sizeof(int));
+    HeapType ready;
+    int complete = 0, next = 0;
+    SimTimeType t = 0;
+    
+    sort_by_arrival(plist, n, order);
+    heap_init(&ready, n);
+    
+    while (complete != n) {
+        // If no process is ready, jump to next arrival time
+        if (ready.size == 0 && plist[order[next]].art > t) {
+            t = plist[order[next]].art;
+        }
+        
+        // Ready queue is keyed on remaining time, ties go to lower index
+        while (next < n && plist[order[next]].art <= t) {
+            heap_push(&ready, plist[order[next]].bt, order[next]);
+            next++;
+        }
+        
+        HeapNodeType shortest = heap_pop(&ready);
+        int curr = shortest.idx;
+        SimTimeType rem = shortest.key;
+        
+        // First dispatch of this process
+        if (rem == plist[curr].bt) {
+            plist[curr].rt = t - plist[curr].art;
+        }
+        
+        // Run until completion or the next arrival, whichever is first
+        if (next == n || t + rem <= plist[order[next]].art) {
+            t += rem;
+            complete++;
+            
+            // Waiting time = finish time - burst time - arrival time
+            plist[curr].wt = t - plist[curr].bt - plist[curr].art;
+            
+            if (plist[curr].wt < 0)
+                plist[curr].wt = 0;
+        } else {
+            rem -= plist[order[next]].art - t;
+            t = plist[order[next]].art;
+            heap_push(&ready, rem, curr);
+        }
+    }
+    
+    heap_free(&ready);
+    mem_free(order);
+}
+
+// IMPROVED: Function to find waiting time for Round Robin
+// Now properly handles arrival times
+void findWaitingTimeRR(ProcessType plist[], int n, SimTimeType quantum) {
+    SimTimeType *rem_bt = (SimTimeType *)mem_alloc(n * sizeof(SimTimeType));
+    SimTimeType *finish_time = (SimTimeType *)mem_alloc(n * sizeof(SimTimeType));
+    int *in_queue = (int *)mem_alloc(n * sizeof(int));  // Track if process is in ready queue
+    int *queue = (int *)mem_alloc(n * sizeof(int));    // Ready queue (circular)
+    int front = 0, rear = 0, queue_size = 0;
+    
+    // Copy burst times
+    for (int i = 0; i < n; i++) {
+        rem_bt[i] = plist[i].bt;
+        finish_time[i] = 0;
+    }
+    
+    // Sort indices by arrival time for initial queue loading
+    int *sorted_idx = (int *)mem_alloc(n * sizeof(int));
+    sort_by_arrival(plist, n, sorted_idx);
+    
+    SimTimeType t = 0;
+    int completed = 0;
+    int next_arrival_idx = 0;  // Index into sorted_idx for next process to arrive
+    
+    // Add all processes that arrive at time 0
+    while (next_arrival_idx < n && plist[sorted_idx[next_arrival_idx]].art <= t) {
+        int idx = sorted_idx[next_arrival_idx];
+        queue[rear] = idx;
+        rear = (rear + 1) % n;
+        queue_size++;
+        in_queue[idx] = 1;
+        next_arrival_idx++;
+    }
+    
+    while (completed < n) {
+        // If queue is empty, jump to next arrival
+        if (queue_size == 0) {
+            if (next_arrival_idx < n) {
+                t = plist[sorted_idx[next_arrival_idx]].art;
+                // Add all processes arriving at this time
+                while (next_arrival_idx < n && plist[sorted_idx[next_arrival_idx]].art <= t) {
+                    int idx = sorted_idx[next_arrival_idx];
+                    queue[rear] = idx;
+                    rear = (rear + 1) % n;
+                    queue_size++;
+                    in_queue[idx] = 1;
+                    next_arrival_idx++;
+                }
+            }
+            continue;
+        }
+        
+        // Get next process from queue
+        int curr = queue[front];
+        front = (front + 1) % n;
+        queue_size--;
+        
+        // First dispatch of this process
+        if (rem_bt[curr] == plist[curr].bt) {
+            plist[curr].rt = t - plist[curr].art;
+        }
+        
+        // Execute for quantum or remaining time, whichever is smaller
+        SimTimeType exec_time = (rem_bt[curr] > quantum) ? quantum : rem_bt[curr];
+        t += exec_time;
+        rem_bt[curr] -= exec_time;
+        
+        // Add newly arrived processes to queue (arrived during this quantum)
+        while (next_arrival_idx < n && plist[sorted_idx[next_arrival_idx]].art <= t) {
+            int idx = sorted_idx[next_arrival_idx];
+            if (!in_queue[idx] && rem_bt[idx] > 0) {
+                queue[rear] = idx;
+                rear = (rear + 1) % n;
+                queue_size++;
+                in_queue[idx] = 1;
+            }
+            next_arrival_idx++;
+        }
+        
+        // Check if current process is done
+        if (rem_bt[curr] == 0) {
+            completed++;
+            finish_time[curr] = t;
+            // Waiting time = finish time - burst time - arrival time
+            plist[curr].wt = finish_time[curr] - plist[curr].bt - plist[curr].art;
+            if (plist[curr].wt < 0) plist[curr].wt = 0;
+        } else {
+            // Put back in queue
+            queue[rear] = curr;
+            rear = (rear + 1) % n;
+            queue_size++;
+        }
+    }
+    
+    mem_free(rem_bt);
+    mem_free(finish_time);
+    mem_free(in_queue);
+    mem_free(queue);
+    mem_free(sorted_idx);
+}
+
+// Function to calculate average time for FCFS
+void findavgTimeFCFS(ProcessType plist[], int n, MetricsType *m) {
+    findWaitingTimeFCFS(plist, NULL, n);
+    findTurnAroundTime(plist, n, m);
+    printf("\n*********\nFCFS\n");
+}
+
+// Function to calculate average time for Priority Scheduling
+// plist stays in input order; order receives the dispatch order,
+// highest priority first with ties in input order
+void findavgTimePriority(ProcessType plist[], int order[], int n, MetricsType *m) {
+    uint64_t *keys = (uint64_t *)mem_alloc(n * sizeof(uint64_t));
+    
+    for (int i = 0; i < n; i++) {
+        keys[i] = RADIX_KEY_DESC(plist[i].pri);
+        order[i] = i;
+    }
+    radix_sort_index(keys, order, n, 0);
+    mem_free(keys);
+    findWaitingTimeFCFS(plist, order, n);
+    findTurnAroundTime(plist, n, m);
+    printf("\n*********\nPriority\n");
+}
+
+// Function to calculate average time for SJF
+void findavgTimeSJF(ProcessType plist[], int n, MetricsType *m) {
+    findWaitingTimeSJF(plist, n);
+    findTurnAroundTime(plist, n, m);
+    printf("\n*********\nSJF\n");
+}
+
+// Function to calculate average time for Round Robin
+void findavgTimeRR(ProcessType plist[], int n, SimTimeType quantum, MetricsType *m) {
+    findWaitingTimeRR(plist, n, quantum);
+    findTurnAroundTime(plist, n, m);
+    printf("\n*********\nRR Quantum = %" PRIdTIME "\n", quantum);
+}
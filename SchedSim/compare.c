@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "compare.h"
+#include "metrics.h"
+#include "process.h"
+
+static const char *objective_names[] = {
+    "wt", "tat", "rt", "slowdown", "p95rt", "jain",
+};
+
+#define NUM_OBJECTIVES ((int) (sizeof(objective_names) / sizeof(objective_names[0])))
+
+/**
+ * Parses a comma separated objective list such as "wt,rt" into objs.
+ * Returns the number of objectives, or -1 on an unknown name.
+ */
+int compare_parse_objectives(const char *spec, ObjectiveType objs[], int max)
+{
+    int count = 0;
+
+    while (*spec != '\0' && count < max) {
+        size_t len = strcspn(spec, ",");
+        int found = -1;
+
+        for (int o = 0; o < NUM_OBJECTIVES; o++) {
+            if (strlen(objective_names[o]) == len && strncmp(spec, objective_names[o], len) == 0)
+                found = o;
+        }
+        if (found < 0)
+            return -1;
+        objs[count++] = (ObjectiveType) found;
+        spec += len;
+        if (*spec == ',')
+            spec++;
+    }
+    return count;
+}
+
+// Per-process value of an objective; aggregate-only ones fall back to slowdown
+static double process_value(const ProcessType *p, ObjectiveType obj)
+{
+    switch (obj) {
+    case OBJ_WT:
+        return p->wt;
+    case OBJ_TAT:
+        return p->tat;
+    case OBJ_RT:
+    case OBJ_P95_RT:
+        return p->rt;
+    default:
+        return (double) p->tat / (p->bt > 0 ? p->bt : 1);
+    }
+}
+
+// Aggregate value of an objective, oriented so that lower is better
+static double policy_score(const MetricsType *m, ObjectiveType obj)
+{
+    switch (obj) {
+    case OBJ_WT:
+        return (double) m->total_wt / m->n;
+    case OBJ_TAT:
+        return (double) m->total_tat / m->n;
+    case OBJ_RT:
+        return (double) m->total_rt / m->n;
+    case OBJ_SLOWDOWN:
+        return stat_mean(&m->slowdown);
+    case OBJ_P95_RT:
+        return stat_percentile(&m->response, 0.95);
+    case OBJ_JAIN:
+        return -stat_jain(&m->slowdown);
+    }
+    return 0.0;
+}
+
+// True if policy a ranks ahead of b: first objective decides, later ones break ties
+static int ranks_before(const PolicyResultType *a, const PolicyResultType *b,
+                        const ObjectiveType objs[], int nobj)
+{
+    for (int k = 0; k < nobj; k++) {
+        double sa = policy_score(a->m, objs[k]);
+        double sb = policy_score(b->m, objs[k]);
+        if (sa != sb)
+            return sa < sb;
+    }
+    return 0;
+}
+
+/**
+ * Prints per-process values of the first objective under every policy
+ * with deltas against the first policy (the baseline), the processes
+ * that gain and lose most under each policy, and a ranking of the
+ * policies by the objective list
+ */
+void compare_policies(const PolicyResultType res[], int npol, int n,
+                      const ObjectiveType objs[], int nobj)
+{
+    ObjectiveType key = objs[0];
+    int best[npol], worst[npol];
+    double best_d[npol], worst_d[npol];
+    int rank[npol];
+
+    printf("\n*********\nComparison (%s, baseline %s)\n", objective_names[key], res[0].name);
+    printf("\tProcesses");
+    for (int k = 0; k < npol; k++)
+        printf(k == 0 ? "\t%s" : "\t%s\tdelta", res[k].name);
+    printf("\n");
+
+    for (int k = 0; k < npol; k++) {
+        best[k] = worst[k] = -1;
+        best_d[k] = worst_d[k] = 0.0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        double base = process_value(&res[0].plist[i], key);
+
+        printf("\t%d\t\t%.2f", res[0].plist[i].pid, base);
+        for (int k = 1; k < npol; k++) {
+            const ProcessType *p = &res[k].plist[i];
+            double d = process_value(p, key) - base;
+
+            if (p->pid != res[0].plist[i].pid) {
+                printf("\nError: %s results are not in input order\n", res[k].name);
+                return;
+            }
+            printf("\t%.2f\t%+.2f", process_value(p, key), d);
+            if (best[k] < 0 || d < best_d[k]) {
+                best[k] = i;
+                best_d[k] = d;
+            }
+            if (worst[k] < 0 || d > worst_d[k]) {
+                worst[k] = i;
+                worst_d[k] = d;
+            }
+        }
+        printf("\n");
+    }
+
+    printf("\n");
+    for (int k = 1; k < npol; k++) {
+        printf("%s vs %s: largest gain process %d (%+.2f), largest loss process %d (%+.2f)\n",
+               res[k].name, res[0].name,
+               res[0].plist[best[k]].pid, best_d[k],
+               res[0].plist[worst[k]].pid, worst_d[k]);
+    }
+
+    // Insertion sort is fine for the handful of policies we compare
+    for (int k = 0; k < npol; k++) {
+        int j = k;
+        while (j > 0 && ranks_before(&res[k], &res[rank[j - 1]], objs, nobj)) {
+            rank[j] = rank[j - 1];
+            j--;
+        }
+        rank[j] = k;
+    }
+
+    printf("\n\tRank\tPolicy");
+    for (int o = 0; o < nobj; o++)
+        printf("\t%s", objective_names[objs[o]]);
+    printf("\n");
+    for (int k = 0; k < npol; k++) {
+        const PolicyResultType *r = &res[rank[k]];
+        printf("\t%d\t%s", k + 1, r->name);
+        for (int o = 0; o < nobj; o++) {
+            double v = policy_score(r->m, objs[o]);
+            printf("\t%.3f", objs[o] == OBJ_JAIN ? -v : v);
+        }
+        printf("\n");
+    }
+}
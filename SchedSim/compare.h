@@ -0,0 +1,33 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include "process.h"
+#include "metrics.h"
+
+/**
+ * Side-by-side policy comparison. Every policy's plist copy is kept in
+ * input order, so row i of each copy is the same process and the join
+ * by pid is a single O(n) walk.
+ */
+
+#define MAX_OBJECTIVES 8
+
+typedef enum Objective {
+    OBJ_WT,			// mean waiting time
+    OBJ_TAT,		// mean turnaround time
+    OBJ_RT,			// mean response time
+    OBJ_SLOWDOWN,	// mean slowdown
+    OBJ_P95_RT,		// 95th percentile response time
+    OBJ_JAIN,		// Jain's fairness index over slowdown (higher is better)
+} ObjectiveType;
+
+typedef struct PolicyResult {
+    const char *name;
+    const ProcessType *plist;	// in input order
+    const MetricsType *m;
+} PolicyResultType;
+
+int compare_parse_objectives(const char *, ObjectiveType[], int);
+void compare_policies(const PolicyResultType[], int, int, const ObjectiveType[], int);
+
+#endif				// COMPARE_H
@@ -0,0 +1,749 @@
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "engine.h"
+#include "fork.h"
+#include "heap.h"
+#include "metrics.h"
+#include "noise.h"
+#include "pool.h"
+#include "process.h"
+
+/**
+ * One live process. A process whose burst is done but which still has
+ * children stays in its slot, off every queue, until the last of them
+ * completes.
+ */
+typedef struct Slot {
+    ProcessType p;
+    SimTimeType rem;		// remaining burst
+    int parent;			// slot of the parent, -1 for source processes
+    int children;		// live children
+    int fork_next;		// next fork spec of this process
+    int fork_end;
+    int prev, next;		// in the list of processes that may be dropped
+    long shed_key;		// of this process's entry in the victim heap
+    uint32_t seq;		// admission order, breaks ready queue ties
+    bool started;
+    bool done;			// burst finished, waiting for children
+    bool listed;		// may be dropped by admission control
+    bool shed;			// dropped, to be skipped by the ready queue
+} SlotType;
+
+/**
+ * Live processes are kept in slots from a pool, whose chunks never
+ * move, so slot numbers held by the ready queues and parent links stay
+ * valid as it grows. Slots of finished processes are reused, so the
+ * pool never holds more than the peak number of processes in the
+ * system. FCFS and RR use a FIFO ring of slots, Priority and SJF a heap
+ * whose ties go to the earlier admission, not the lower slot.
+ * A process dropped by admission control is only marked in its slot;
+ * the ready queue frees the slot when it reaches it.
+ */
+// Empties the pool and queues for the next run, keeping their memory
+static void work_reset(EngineWorkType *s)
+{
+    pool_reset(&s->slots);
+    s->fifo_head = s->fifo_size = 0;
+    s->heap.size = 0;
+    s->shed_queued = 0;
+    s->oldest = s->newest = -1;
+    s->listed = 0;
+    s->victims.size = 0;
+    s->admissions = 0;
+    s->backlog = 0;
+}
+
+void engine_work_init(EngineWorkType *s)
+{
+    pool_init(&s->slots, sizeof(SlotType));
+    s->ring_cap = POOL_CHUNK;
+    s->fifo = (int *) malloc(s->ring_cap * sizeof(int));
+    s->fifo_head = s->fifo_size = 0;
+    heap_init(&s->heap, s->ring_cap);
+    s->victims.nodes = NULL;
+    s->victims.size = s->victims.cap = 0;
+    s->mallocs = 2;
+    work_reset(s);
+}
+
+void engine_work_free(EngineWorkType *s)
+{
+    pool_destroy(&s->slots);
+    heap_free(&s->heap);
+    heap_free(&s->victims);
+    free(s->fifo);
+}
+
+// Calls to the system allocator so far, by the pool and the queues
+long engine_work_mallocs(const EngineWorkType *s)
+{
+    return s->mallocs + s->slots.stats.mallocs;
+}
+
+static SlotType *slot_at(const EngineWorkType *s, int slot)
+{
+    return (SlotType *) POOL_AT(&s->slots, slot);
+}
+
+static int slot_alloc(EngineWorkType *s)
+{
+    int slot = pool_alloc(&s->slots);
+
+    // The ring must hold every live slot
+    if (s->slots.stats.live > s->ring_cap) {
+        int old = s->ring_cap;
+        int *fifo = (int *) malloc(2 * old * sizeof(int));
+
+        // Unroll the ring so it stays contiguous in the larger buffer
+        for (int i = 0; i < s->fifo_size; i++)
+            fifo[i] = s->fifo[(s->fifo_head + i) % old];
+        free(s->fifo);
+        s->fifo = fifo;
+        s->fifo_head = 0;
+        s->ring_cap = 2 * old;
+        s->mallocs++;
+    }
+    return slot;
+}
+
+static void slot_free(EngineWorkType *s, int slot)
+{
+    pool_free(&s->slots, slot);
+}
+
+static void ready_push(const EngineType *e, EngineWorkType *s, int slot)
+{
+    switch (e->policy) {
+    case POLICY_FCFS:
+    case POLICY_RR:
+        s->fifo[(s->fifo_head + s->fifo_size++) % s->ring_cap] = slot;
+        break;
+    case POLICY_PRIORITY:
+    case POLICY_SJF:
+        if (s->heap.size == s->heap.cap)
+            s->mallocs++;
+        if (e->policy == POLICY_PRIORITY)
+            heap_push_tie(&s->heap, -(long) slot_at(s, slot)->p.pri, slot_at(s, slot)->seq, slot);
+        else
+            heap_push_tie(&s->heap, slot_at(s, slot)->rem, slot_at(s, slot)->seq, slot);
+        break;
+    }
+}
+
+// Pops the next process to run, freeing dropped ones on the way
+static int ready_pop(const EngineType *e, EngineWorkType *s)
+{
+    for (;;) {
+        int slot;
+
+        if (e->policy == POLICY_FCFS || e->policy == POLICY_RR) {
+            slot = s->fifo[s->fifo_head];
+            s->fifo_head = (s->fifo_head + 1) % s->ring_cap;
+            s->fifo_size--;
+        } else {
+            slot = heap_pop(&s->heap).idx;
+        }
+        if (!slot_at(s, slot)->shed)
+            return slot;
+        s->shed_queued--;
+        slot_free(s, slot);
+    }
+}
+
+static int ready_size(const EngineType *e, const EngineWorkType *s)
+{
+    if (e->policy == POLICY_FCFS || e->policy == POLICY_RR)
+        return s->fifo_size - s->shed_queued;
+    return s->heap.size - s->shed_queued;
+}
+
+static bool ready_empty(const EngineType *e, const EngineWorkType *s)
+{
+    return ready_size(e, s) == 0;
+}
+
+// Whether SJF would rather run the top of the ready heap than slot
+static bool sjf_beaten(EngineWorkType *s, int slot)
+{
+    const SlotType *sl = slot_at(s, slot);
+
+    while (s->heap.size > 0 && slot_at(s, s->heap.nodes[0].idx)->shed) {
+        slot_free(s, heap_pop(&s->heap).idx);
+        s->shed_queued--;
+    }
+    if (s->heap.size == 0)
+        return false;
+    HeapNodeType top = s->heap.nodes[0];
+    return top.key < sl->rem || (top.key == sl->rem && (int32_t) (top.tie - sl->seq) < 0);
+}
+
+// First tick at or after x, or x itself without ticks
+static SimTimeType tick_up(const EngineType *e, SimTimeType x)
+{
+    if (e->tick <= 0 || x % e->tick == 0)
+        return x;
+    return x + e->tick - x % e->tick;
+}
+
+static SimTimeType decision_cost(const DecisionCostType *c, int queue)
+{
+    switch (c->model) {
+    case COST_CONST:
+        return llround(c->a);
+    case COST_LOG:
+        return llround(c->a * log2(queue + 1.0));
+    case COST_LINEAR:
+        return llround(c->a * queue);
+    default:
+        return 0;
+    }
+}
+
+// Victim heap keys: lowest pri first, then the latest to arrive
+static long shed_key(int pri, long admission)
+{
+    return pri * 4294967296L + (4294967295L - (admission & 4294967295L));
+}
+
+// Appends slot to the processes admission control may drop
+static void shed_link(const EngineType *e, EngineWorkType *s, int slot)
+{
+    SlotType *sl = slot_at(s, slot);
+
+    sl->listed = true;
+    sl->prev = s->newest;
+    sl->next = -1;
+    if (s->newest >= 0)
+        slot_at(s, s->newest)->next = slot;
+    else
+        s->oldest = slot;
+    s->newest = slot;
+    s->listed++;
+    if (e->admission->shed != SHED_LOWEST_PRI)
+        return;
+
+    sl->shed_key = shed_key(sl->p.pri, s->admissions);
+    // Entries of processes that left the list are only dropped when
+    // they reach the top; rebuild once they outnumber the live ones
+    if (s->victims.size > 2 * s->listed + POOL_CHUNK) {
+        s->victims.size = 0;
+        for (int i = s->oldest; i >= 0; i = slot_at(s, i)->next)
+            heap_push(&s->victims, slot_at(s, i)->shed_key, i);
+        return;
+    }
+    if (s->victims.cap == 0) {
+        heap_init(&s->victims, POOL_CHUNK);
+        s->mallocs++;
+    } else if (s->victims.size == s->victims.cap) {
+        s->mallocs++;
+    }
+    heap_push(&s->victims, sl->shed_key, slot);
+}
+
+static void shed_unlink(EngineWorkType *s, int slot)
+{
+    SlotType *sl = slot_at(s, slot);
+
+    if (sl->prev >= 0)
+        slot_at(s, sl->prev)->next = sl->next;
+    else
+        s->oldest = sl->next;
+    if (sl->next >= 0)
+        slot_at(s, sl->next)->prev = sl->prev;
+    else
+        s->newest = sl->prev;
+    sl->listed = false;
+    s->listed--;
+}
+
+static void admit(const EngineType *e, EngineWorkType *s, const ProcessType *p, int parent)
+{
+    int slot = slot_alloc(s);
+    SlotType *sl = slot_at(s, slot);
+
+    sl->p = *p;
+    sl->rem = p->bt;
+    sl->parent = parent;
+    sl->children = 0;
+    sl->started = sl->done = false;
+    sl->listed = sl->shed = false;
+    sl->fork_next = sl->fork_end = 0;
+    if (e->forks != NULL)
+        sl->fork_next = fork_find(e->forks, p->pid, &sl->fork_end);
+    s->backlog += p->bt;
+    sl->seq = (uint32_t) s->admissions++;
+    if (parent < 0 && e->admission != NULL && e->admission->shed != SHED_REJECT
+        && e->admission->shed != SHED_DEADLINE)
+        shed_link(e, s, slot);
+    ready_push(e, s, slot);
+}
+
+// Earliest arrival that is waiting, or -1
+static int oldest_waiting(const EngineWorkType *s, int running, int requeue)
+{
+    for (int slot = s->oldest; slot >= 0; slot = slot_at(s, slot)->next) {
+        if (slot != running && slot != requeue)
+            return slot;
+    }
+    return -1;
+}
+
+// Waiting process with the lowest pri, or -1
+static int lowest_waiting(EngineWorkType *s, int running, int requeue)
+{
+    HeapNodeType held[2];
+    int nheld = 0, victim = -1;
+
+    while (s->victims.size > 0) {
+        HeapNodeType top = s->victims.nodes[0];
+        const SlotType *sl = slot_at(s, top.idx);
+
+        if (sl->listed && sl->shed_key == top.key && top.idx != running && top.idx != requeue) {
+            victim = top.idx;
+            break;
+        }
+        heap_pop(&s->victims);
+        // Not waiting right now, but still a candidate later
+        if (sl->listed && sl->shed_key == top.key)
+            held[nheld++] = top;
+    }
+    while (nheld > 0) {
+        nheld--;
+        heap_push(&s->victims, held[nheld].key, held[nheld].idx);
+    }
+    return victim;
+}
+
+/**
+ * Frees the slots of dropped processes still in the ready queue. The
+ * order of the others is kept, so it does not change what runs next.
+ */
+static void ready_compact(const EngineType *e, EngineWorkType *s)
+{
+    int kept = 0;
+
+    if (e->policy == POLICY_FCFS || e->policy == POLICY_RR) {
+        for (int i = 0; i < s->fifo_size; i++) {
+            int slot = s->fifo[(s->fifo_head + i) % s->ring_cap];
+            if (slot_at(s, slot)->shed)
+                slot_free(s, slot);
+            else
+                s->fifo[(s->fifo_head + kept++) % s->ring_cap] = slot;
+        }
+        s->fifo_size = kept;
+    } else {
+        for (int i = 0; i < s->heap.size; i++) {
+            HeapNodeType node = s->heap.nodes[i];
+            if (slot_at(s, node.idx)->shed)
+                slot_free(s, node.idx);
+            else
+                s->heap.nodes[kept++] = node;
+        }
+        // Pushing node k only writes the first k + 1 nodes
+        s->heap.size = 0;
+        for (int k = 0; k < kept; k++) {
+            HeapNodeType node = s->heap.nodes[k];
+            heap_push_tie(&s->heap, node.key, node.tie, node.idx);
+        }
+    }
+    s->shed_queued = 0;
+}
+
+// Drops a waiting process; its slot is freed when it reaches the head
+// of the ready queue, or when dropped processes outnumber the others
+static void drop(const EngineType *e, EngineWorkType *s, SourceType *src, MetricsType *m, int slot,
+                 SimTimeType t)
+{
+    SlotType *sl = slot_at(s, slot);
+
+    shed_unlink(s, slot);
+    sl->shed = true;
+    s->shed_queued++;
+    s->backlog -= sl->rem;
+    m->dropped++;
+    if (src->complete != NULL)
+        src->complete(src, &sl->p, t);
+    if (s->shed_queued > ready_size(e, s) + POOL_CHUNK)
+        ready_compact(e, s);
+}
+
+/**
+ * Decides whether arrival a may join the ready queue at t, dropping a
+ * waiting process to make room for it if the policy says so. running
+ * and requeue are off the ready queue but may not be dropped.
+ */
+static bool offer(const EngineType *e, EngineWorkType *s, SourceType *src, MetricsType *m,
+                  const ProcessType *a, SimTimeType t, int running, int requeue)
+{
+    const AdmissionType *ad = e->admission;
+    bool full = ad->capacity > 0 && ready_size(e, s) + (requeue >= 0) >= ad->capacity;
+    int victim = -1;
+
+    switch (ad->shed) {
+    case SHED_REJECT:
+        return !full;
+    case SHED_DEADLINE:
+        return !full && t + s->backlog + a->bt <= a->art + ad->slack * a->bt;
+    case SHED_OLDEST:
+        if (!full)
+            return true;
+        victim = oldest_waiting(s, running, requeue);
+        break;
+    case SHED_LOWEST_PRI:
+        if (!full)
+            return true;
+        victim = lowest_waiting(s, running, requeue);
+        if (victim >= 0 && slot_at(s, victim)->p.pri >= a->pri)
+            return false;
+        break;
+    }
+    // Only processes that may not be dropped are waiting
+    if (victim < 0)
+        return false;
+    drop(e, s, src, m, victim, t);
+    return true;
+}
+
+/**
+ * Admits the source arrivals due by t, a being the next one, subject
+ * to admission control. Returns whether another arrival is pending.
+ */
+static bool admit_due(const EngineType *e, EngineWorkType *s, SourceType *src, MetricsType *m,
+                      ProcessType *a, bool pending, SimTimeType t, int running, int requeue)
+{
+    while (pending && a->art <= t) {
+        // Popped first, as turning a process away may make a
+        // closed-loop source issue another
+        src->pop(src);
+        if (e->admission == NULL) {
+            admit(e, s, a, -1);
+        } else if (offer(e, s, src, m, a, t, running, requeue)) {
+            admit(e, s, a, -1);
+            m->admitted++;
+        } else {
+            m->rejected++;
+            if (src->complete != NULL)
+                src->complete(src, a, t);
+        }
+        pending = src->peek(src, a);
+    }
+    return pending;
+}
+
+// Creates every child whose fork point the running process has reached
+static void fork_children(const EngineType *e, EngineWorkType *s, int slot, SimTimeType t)
+{
+    SlotType *sl = slot_at(s, slot);
+
+    while (sl->fork_next < sl->fork_end
+           && e->forks->specs[sl->fork_next].at <= sl->p.bt - sl->rem) {
+        const ForkSpecType *spec = &e->forks->specs[sl->fork_next++];
+        ProcessType child = { 0 };
+
+        child.pid = spec->pid;
+        child.bt = spec->bt;
+        child.art = t;
+        child.pri = sl->p.pri;
+        child.tenant = sl->p.tenant;
+        sl->children++;
+        if (sl->listed)
+            shed_unlink(s, slot);
+        admit(e, s, &child, slot);
+    }
+}
+
+/**
+ * Completes slot at t, then any ancestors that were only waiting for
+ * it. Only source processes are handed back to the source.
+ */
+static void finish(EngineWorkType *s, SourceType *src, MetricsType *m, int slot, SimTimeType t)
+{
+    while (slot >= 0) {
+        SlotType *sl = slot_at(s, slot);
+        int parent = sl->parent;
+
+        sl->done = true;
+        if (sl->children > 0)
+            return;
+        if (sl->listed)
+            shed_unlink(s, slot);
+
+        sl->p.tat = t - sl->p.art;
+        sl->p.wt = sl->p.tat - sl->p.bt;
+        metrics_add(m, &sl->p);
+        if (parent < 0 && src->complete != NULL)
+            src->complete(src, &sl->p, t);
+        slot_free(s, slot);
+
+        if (parent < 0)
+            return;
+        sl = slot_at(s, parent);
+        if (--sl->children > 0 || !sl->done)
+            return;
+        slot = parent;
+    }
+}
+
+/**
+ * Serves the noise events that start before until, or before the CPU
+ * is free of earlier ones, back to back from t. Returns the time the
+ * CPU is free again.
+ */
+static SimTimeType serve_noise(NoiseType *nz, SimTimeType t, SimTimeType until)
+{
+    while (nz->at < until || nz->at <= t) {
+        if (nz->at > t)
+            t = nz->at;
+        t += nz->len;
+        nz->events++;
+        nz->stolen += nz->len;
+        noise_advance(nz);
+    }
+    return t;
+}
+
+/**
+ * Runs the source to exhaustion under e's policy and returns the time
+ * the last process finished. FCFS, SJF and RR match the
+ * findWaitingTime* functions on arrival-sorted input: RR queues
+ * arrivals that came in during a slice ahead of the preempted process,
+ * SJF preempts on arrival, FCFS never preempts. Priority does not: it
+ * runs the highest pri among the processes that have arrived and never
+ * preempts, where the classic version orders the whole trace by pri
+ * and may sit idle waiting for a later arrival. Ties between equal
+ * keys go to the earlier admission, which is input order on sorted
+ * input. A fork point ends the current slice: SJF then
+ * reconsiders the running process like on an arrival, the other
+ * policies keep running it, RR within the same quantum. Noise cuts a
+ * slice the same way; time lost to it is not charged to the quantum.
+ */
+SimTimeType engine_run(const EngineType *e, SourceType *src, MetricsType *m)
+{
+    EngineWorkType local, *s = e->work;
+    ProcessType a;
+    SimTimeType t = 0;
+    int running = -1, requeue = -1;
+    SimTimeType used = 0;	// of the running process's quantum
+    ProgressType *pr = e->progress;
+    long events = 0, next_publish = PROGRESS_STRIDE;
+    NoiseType *nz = e->noise;
+
+    if (s == NULL) {
+        s = &local;
+        engine_work_init(s);
+    } else {
+        work_reset(s);
+    }
+    metrics_init(m);
+    if (nz != NULL)
+        noise_rewind(nz);
+
+    for (;;) {
+        // Published for the progress thread, which may also ask us to
+        // stop; what has completed so far stays in m
+        if (pr != NULL && ++events == next_publish) {
+            next_publish += PROGRESS_STRIDE;
+            __atomic_store_n(&pr->now, t, __ATOMIC_RELAXED);
+            __atomic_store_n(&pr->events, events, __ATOMIC_RELAXED);
+            __atomic_store_n(&pr->done, m->n, __ATOMIC_RELAXED);
+            if (__atomic_load_n(&pr->stop, __ATOMIC_RELAXED))
+                break;
+        }
+
+        bool pending = src->peek(src, &a);
+
+        // Idle CPU: stop if nothing else will arrive, else jump ahead
+        if (running < 0 && requeue < 0 && ready_empty(e, s)) {
+            if (!pending)
+                break;
+            SimTimeType wake = e->tickless ? a.art : tick_up(e, a.art);
+            if (nz != NULL)
+                t = serve_noise(nz, t, wake);
+            if (wake > t)
+                t = wake;
+        }
+        // Interrupts that are due take the CPU before any process
+        if (nz != NULL && nz->at <= t)
+            t = serve_noise(nz, t, t);
+
+        pending = admit_due(e, s, src, m, &a, pending, t, running, requeue);
+        if (requeue >= 0) {
+            ready_push(e, s, requeue);
+            requeue = -1;
+        }
+        // Everything that came in was turned away
+        if (running < 0 && ready_empty(e, s))
+            continue;
+
+        if (running < 0) {
+            SlotType *sl;
+            int queue = ready_size(e, s);
+            running = ready_pop(e, s);
+            if (e->costs != NULL && e->costs[e->policy].model != COST_FREE) {
+                SimTimeType cost = decision_cost(&e->costs[e->policy], queue);
+
+                m->decisions++;
+                m->decision_queue += queue;
+                m->overhead += cost;
+                t += cost;
+                if (nz != NULL && nz->at <= t)
+                    t = serve_noise(nz, t, t);
+                // Too late for this decision, in time for the next
+                pending = admit_due(e, s, src, m, &a, pending, t, running, -1);
+                // which under SJF may preempt the process just chosen
+                if (e->policy == POLICY_SJF && sjf_beaten(s, running)) {
+                    requeue = running;
+                    running = -1;
+                    continue;
+                }
+            }
+            used = 0;
+            sl = slot_at(s, running);
+            // First dispatch of this process
+            if (!sl->started)
+                sl->p.rt = t - sl->p.art;
+            sl->started = true;
+        }
+
+        SlotType *sl = slot_at(s, running);
+        SimTimeType run = sl->rem;
+        bool preempt = false;
+        if (e->policy == POLICY_RR) {
+            SimTimeType expiry = tick_up(e, t + e->quantum - used) - t;
+            if (run > expiry) {
+                run = expiry;
+                preempt = true;
+            }
+        }
+        if (e->policy == POLICY_SJF && pending && tick_up(e, a.art) < t + run) {
+            run = tick_up(e, a.art) - t;
+            preempt = true;
+        }
+        if (sl->fork_next < sl->fork_end) {
+            SimTimeType to_fork = e->forks->specs[sl->fork_next].at - (sl->p.bt - sl->rem);
+            if (to_fork < run) {
+                run = to_fork > 0 ? to_fork : 0;
+                preempt = e->policy == POLICY_SJF;
+            }
+        }
+        if (nz != NULL && nz->at < t + run) {
+            run = nz->at - t;
+            preempt = e->policy == POLICY_SJF;
+        }
+
+        t += run;
+        used += run;
+        sl->rem -= run;
+        s->backlog -= run;
+        fork_children(e, s, running, t);
+        if (sl->rem == 0) {
+            finish(s, src, m, running, t);
+            running = -1;
+        } else if (preempt || (e->policy == POLICY_RR && used >= e->quantum)) {
+            requeue = running;
+            running = -1;
+        }
+    }
+
+    if (s == &local)
+        engine_work_free(s);
+    return t;
+}
+
+const char *engine_policy_name(PolicyType policy)
+{
+    static const char *names[] = { "FCFS", "Priority", "SJF", "RR" };
+    return names[policy];
+}
+
+/**
+ * Parses a comma separated list of [policy=]model:a, model being const,
+ * log or linear; without a policy name the entry applies to all of
+ * them. Policies not named keep their cost. Returns 0 on success, -1
+ * on a malformed entry.
+ */
+int engine_parse_costs(const char *spec, DecisionCostType costs[])
+{
+    static const char *models[] = { "free", "const", "log", "linear" };
+    char buf[256];
+    char *save = NULL;
+
+    if (strlen(spec) >= sizeof(buf))
+        return -1;
+    strcpy(buf, spec);
+    for (char *entry = strtok_r(buf, ",", &save); entry != NULL; entry = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(entry, '=');
+        char *colon;
+        int first = 0, last = NUM_POLICIES - 1, model = -1;
+        DecisionCostType c;
+
+        if (eq != NULL) {
+            *eq = '\0';
+            first = -1;
+            for (int p = 0; p < NUM_POLICIES; p++) {
+                if (strcasecmp(entry, engine_policy_name((PolicyType) p)) == 0)
+                    first = last = p;
+            }
+            if (first < 0)
+                return -1;
+            entry = eq + 1;
+        }
+        colon = strchr(entry, ':');
+        if (colon == NULL)
+            return -1;
+        *colon = '\0';
+        for (int k = COST_FREE; k <= COST_LINEAR; k++) {
+            if (strcmp(entry, models[k]) == 0)
+                model = k;
+        }
+        c.model = (CostModelType) model;
+        if (model < 0 || sscanf(colon + 1, "%lf", &c.a) != 1 || c.a < 0)
+            return -1;
+        for (int p = first; p <= last; p++)
+            costs[p] = c;
+    }
+    return 0;
+}
+
+/**
+ * Parses capacity[,policy], policy being reject (the default), oldest,
+ * lowpri or deadline:slack. Returns 0 on success, -1 if spec is
+ * malformed or bounds nothing.
+ */
+int engine_parse_admission(const char *spec, AdmissionType *ad)
+{
+    static const char *names[] = { "reject", "oldest", "lowpri", "deadline" };
+    const char *policy = strchr(spec, ',');
+    char *end;
+    long capacity = strtol(spec, &end, 10);
+
+    if (end == spec || end != (policy != NULL ? policy : spec + strlen(spec)) || capacity < 0
+        || capacity > INT_MAX)
+        return -1;
+    ad->capacity = (int) capacity;
+    ad->shed = SHED_REJECT;
+    ad->slack = 0;
+    if (policy != NULL) {
+        int shed = -1;
+
+        policy++;
+        for (int k = SHED_REJECT; k <= SHED_DEADLINE; k++) {
+            size_t len = strlen(names[k]);
+            if (strncmp(policy, names[k], len) == 0 && (policy[len] == '\0' || policy[len] == ':'))
+                shed = k;
+        }
+        if (shed < 0)
+            return -1;
+        ad->shed = (ShedType) shed;
+        policy = strchr(policy, ':');
+        if ((shed == SHED_DEADLINE) != (policy != NULL))
+            return -1;
+        if (policy != NULL && (sscanf(policy + 1, "%lf", &ad->slack) != 1 || ad->slack <= 0))
+            return -1;
+    }
+    return ad->capacity > 0 || ad->shed == SHED_DEADLINE ? 0 : -1;
+}
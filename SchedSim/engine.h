@@ -0,0 +1,146 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdbool.h>
+#include "fork.h"
+#include "heap.h"
+#include "noise.h"
+#include "pool.h"
+#include "progress.h"
+#include "process.h"
+#include "metrics.h"
+
+/**
+ * Online event driven scheduling engine. Unlike the findWaitingTime*
+ * functions it never sees the whole process list: arrivals are pulled
+ * from a Source as simulated time reaches them, live processes sit in
+ * a slot table, and finished processes are folded into the metrics and
+ * handed back to the source. Memory is O(processes in the system).
+ * With a fork table, processes also create children part way through
+ * their burst; see fork.h.
+ *
+ * With a tick period, preemption is only decided on timer ticks: an RR
+ * slice ends on the first tick after its quantum is used up, and an
+ * arrival preempts SJF on the first tick after it. A wakeup onto an
+ * idle CPU also waits for the next tick, unless the engine is tickless,
+ * in which case the idle CPU is woken at once. Completions, forks and
+ * noise are events and are handled when they happen. Tick times are
+ * computed by rounding event times up, never by stepping through
+ * ticks.
+ */
+
+typedef enum Policy {
+    POLICY_FCFS,
+    POLICY_PRIORITY,	// non-preemptive, highest pri first
+    POLICY_SJF,			// preemptive shortest remaining time first
+    POLICY_RR,
+} PolicyType;
+
+#define NUM_POLICIES (POLICY_RR + 1)
+
+/**
+ * CPU time the scheduler itself spends on each dispatch decision, as a
+ * function of the number n of processes in the ready queue: a, a *
+ * log2(n + 1) or a * n, rounded to whole time units. It is charged
+ * before the chosen process runs; arrivals and noise during it are
+ * handled as soon as it ends.
+ */
+typedef enum CostModel {
+    COST_FREE,
+    COST_CONST,
+    COST_LOG,
+    COST_LINEAR,
+} CostModelType;
+
+typedef struct DecisionCost {
+    CostModelType model;
+    double a;
+} DecisionCostType;
+
+/**
+ * Admission control for overload. When capacity processes are already
+ * waiting, an arrival from the source is turned away, or another
+ * waiting process is dropped to make room for it: the earliest to have
+ * arrived, or the one with the lowest pri, the arrival itself losing
+ * ties. The deadline policy also turns away arrivals that would finish
+ * after art + slack * bt even if they ran after all the work already
+ * in the system. Forked children are always admitted, and processes
+ * that have forked are never dropped.
+ */
+typedef enum Shed {
+    SHED_REJECT,
+    SHED_OLDEST,
+    SHED_LOWEST_PRI,
+    SHED_DEADLINE,
+} ShedType;
+
+typedef struct Admission {
+    ShedType shed;
+    int capacity;		// waiting processes, 0 for no bound
+    double slack;		// deadline as a multiple of the burst
+} AdmissionType;
+
+typedef struct Source SourceType;
+
+/**
+ * Arrival stream. peek() copies the earliest pending arrival without
+ * consuming it and returns false when none is pending right now; a
+ * closed-loop source may produce more later, from complete(). pop()
+ * consumes the arrival last returned by peek(). complete() may be NULL;
+ * it is only called for processes that came from the source, not for
+ * forked children, and also for those admission control turned away.
+ */
+struct Source {
+    bool (*peek)(SourceType *, ProcessType *);
+    void (*pop)(SourceType *);
+    void (*complete)(SourceType *, const ProcessType *, SimTimeType);
+    void *state;
+};
+
+/**
+ * Storage for engine runs: the slot pool and the ready queues. A work
+ * area shared by several runs is reset rather than freed between them,
+ * so once it has grown to the workload's peak the engine no longer
+ * calls malloc.
+ */
+typedef struct EngineWork {
+    PoolType slots;
+    int *fifo;
+    int fifo_head;
+    int fifo_size;
+    int ring_cap;
+    HeapType heap;
+    int shed_queued;		// dropped slots still in a ready queue
+    // Processes admission control may drop, in arrival order, and a
+    // heap of them by pri that is cleaned lazily
+    int oldest, newest;
+    int listed;
+    HeapType victims;
+    long admissions;
+    SimTimeType backlog;	// remaining burst of every live process
+    long mallocs;		// by the queues; the pool counts its own
+} EngineWorkType;
+
+typedef struct Engine {
+    PolicyType policy;
+    SimTimeType quantum;	// RR time slice
+    const ForkTableType *forks;	// NULL when nothing forks
+    EngineWorkType *work;	// NULL for storage private to each run
+    ProgressType *progress;	// NULL when nobody is watching
+    NoiseType *noise;		// NULL for a quiet CPU
+    const DecisionCostType *costs;	// one per policy, NULL when decisions are free
+    SimTimeType tick;		// timer tick period, 0 for exact preemption
+    bool tickless;		// no tick while idle (nohz)
+    const AdmissionType *admission;	// NULL for unbounded queues
+} EngineType;
+
+void engine_work_init(EngineWorkType *);
+void engine_work_free(EngineWorkType *);
+long engine_work_mallocs(const EngineWorkType *);
+
+SimTimeType engine_run(const EngineType *, SourceType *, MetricsType *);
+const char *engine_policy_name(PolicyType);
+int engine_parse_costs(const char *, DecisionCostType[]);
+int engine_parse_admission(const char *, AdmissionType *);
+
+#endif				// ENGINE_H
@@ -0,0 +1,165 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "extsort.h"
+#include "engine.h"
+#include "mem.h"
+#include "merge.h"
+#include "process.h"
+#include "radix.h"
+#include "util.h"
+
+#define INPUT_IO_BUFFER (1 << 22)
+#define RUN_IO_BUFFER (1 << 20)
+
+typedef struct RunJob {
+    pthread_t tid;
+    ProcessType *buf;
+    uint64_t *keys;
+    int *order;
+    long count;
+    FILE *f;
+    char *io;
+    bool busy;
+} RunJobType;
+
+// Sorts one run in memory and writes it out sequentially. Runs are
+// already sorted in parallel with each other, so each uses one thread.
+static void *write_run(void *arg)
+{
+    RunJobType *job = (RunJobType *) arg;
+
+    for (long i = 0; i < job->count; i++) {
+        job->keys[i] = RADIX_KEY(job->buf[i].art);
+        job->order[i] = (int) i;
+    }
+    radix_sort_index(job->keys, job->order, (int) job->count, 1);
+    for (long i = 0; i < job->count; i++) {
+        const ProcessType *p = &job->buf[job->order[i]];
+        TraceRecordType rec;
+
+        trace_record(&rec, p);
+        fwrite(&rec, sizeof(rec), 1, job->f);
+    }
+    fflush(job->f);
+    return NULL;
+}
+
+static void finish_job(ExtSortType *x, RunJobType *job)
+{
+    pthread_join(job->tid, NULL);
+    job->busy = false;
+    x->runs[x->nruns].f = job->f;
+    x->runs[x->nruns].io = job->io;
+    x->runs[x->nruns].count = job->count;
+    x->nruns++;
+}
+
+/**
+ * Phase one: reads in, producing sorted runs with up to threads runs
+ * being sorted and written while the main thread keeps reading.
+ * Returns 0 on success, -1 if a temporary file cannot be created.
+ */
+int extsort_runs(ExtSortType *x, FILE *in, long run_records, int threads)
+{
+    RunJobType *jobs = (RunJobType *) calloc(threads, sizeof(RunJobType));
+    TraceReaderType reader;
+    int cap = 16, next_job = 0, status = 0;
+    bool more = true;
+
+    x->runs = (ExtRunType *) calloc(cap, sizeof(ExtRunType));
+    x->nruns = 0;
+    x->total = 0;
+    x->readers = NULL;
+    x->merging = false;
+
+    // The sort scratch is first written by the worker, which places it
+    // on the worker's NUMA node
+    for (int k = 0; k < threads; k++) {
+        jobs[k].buf = (ProcessType *) mem_alloc(run_records * sizeof(ProcessType));
+        jobs[k].keys = (uint64_t *) mem_alloc(run_records * sizeof(uint64_t));
+        jobs[k].order = (int *) mem_alloc(run_records * sizeof(int));
+    }
+
+    setvbuf(in, NULL, _IOFBF, INPUT_IO_BUFFER);
+    trace_open(&reader, in);
+    while (more) {
+        RunJobType *job = &jobs[next_job];
+
+        // Runs are completed in the order they were started
+        if (job->busy)
+            finish_job(x, job);
+
+        job->count = 0;
+        while (job->count < run_records && (more = trace_read(&reader, &job->buf[job->count])))
+            job->count++;
+        if (job->count == 0)
+            break;
+        x->total += job->count;
+
+        job->f = tmpfile();
+        if (job->f == NULL) {
+            status = -1;
+            break;
+        }
+        if (x->nruns + threads >= cap) {
+            cap *= 2;
+            x->runs = (ExtRunType *) realloc(x->runs, cap * sizeof(ExtRunType));
+        }
+        job->io = (char *) malloc(RUN_IO_BUFFER);
+        setvbuf(job->f, job->io, _IOFBF, RUN_IO_BUFFER);
+        job->busy = true;
+        pthread_create(&job->tid, NULL, write_run, job);
+        next_job = (next_job + 1) % threads;
+    }
+
+    for (int k = 0; k < threads; k++) {
+        RunJobType *job = &jobs[(next_job + k) % threads];
+        if (job->busy)
+            finish_job(x, job);
+    }
+    for (int k = 0; k < threads; k++) {
+        mem_free(jobs[k].buf);
+        mem_free(jobs[k].keys);
+        mem_free(jobs[k].order);
+    }
+    free(jobs);
+    return status;
+}
+
+/**
+ * Phase two: (re)starts the k-way merge over all runs. May be called
+ * again to replay the sorted stream for another policy. Equal arrival
+ * times come out in run order, i.e. input order.
+ */
+void extsort_source(SourceType *src, ExtSortType *x)
+{
+    if (x->merging)
+        merge_free(&x->merge);
+    if (x->readers == NULL)
+        x->readers = (TraceReaderType *) malloc(x->nruns * sizeof(TraceReaderType));
+
+    for (int r = 0; r < x->nruns; r++) {
+        rewind(x->runs[r].f);
+        x->readers[r].f = x->runs[r].f;
+        x->readers[r].binary = TRACE_VERSION;
+        x->readers[r].remaining = x->runs[r].count;
+    }
+    merge_init(&x->merge, x->readers, x->nruns, false);
+    x->merging = true;
+    merge_source(src, &x->merge);
+}
+
+void extsort_free(ExtSortType *x)
+{
+    for (int r = 0; r < x->nruns; r++) {
+        fclose(x->runs[r].f);
+        free(x->runs[r].io);
+    }
+    free(x->runs);
+    free(x->readers);
+    if (x->merging)
+        merge_free(&x->merge);
+}
@@ -0,0 +1,38 @@
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include <stdio.h>
+#include "engine.h"
+#include "merge.h"
+#include "process.h"
+#include "util.h"
+
+/**
+ * Out-of-core sort by arrival time for traces larger than RAM.
+ * extsort_runs() cuts the input into runs of run_records processes,
+ * sorts them on worker threads while the next run is being read, and
+ * writes each as a binary temporary file. extsort_source() then merges
+ * the runs through a loser tree into an arrival stream for the engine,
+ * so the sorted trace is never materialised. Ties keep input order.
+ */
+
+typedef struct ExtRun {
+    FILE *f;
+    char *io;			// stdio buffer, used for writing then merging
+    long count;
+} ExtRunType;
+
+typedef struct ExtSort {
+    ExtRunType *runs;
+    int nruns;
+    long total;
+    TraceReaderType *readers;	// one per run while merging
+    MergeType merge;
+    bool merging;
+} ExtSortType;
+
+int extsort_runs(ExtSortType *, FILE *, long, int);
+void extsort_source(SourceType *, ExtSortType *);
+void extsort_free(ExtSortType *);
+
+#endif				// EXTSORT_H
@@ -0,0 +1,157 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fork.h"
+#include "radix.h"
+
+// Line of the last fork point of pid if it lies beyond bt, else 0
+static int late_fork(const ForkTableType *t, int pid, SimTimeType bt)
+{
+    int end, first = fork_find(t, pid, &end);
+
+    if (first < end && t->specs[end - 1].at > bt)
+        return t->specs[end - 1].line;
+    return 0;
+}
+
+/**
+ * Line of a spec that forks its own parent or an ancestor, or 0. A
+ * depth first search over parents, each known by the index of its
+ * first spec.
+ */
+static int fork_cycle(const ForkTableType *t)
+{
+    char *state = (char *) calloc(t->n, 1);	// 1 on the chain, 2 finished
+    int *first = (int *) malloc(t->n * sizeof(int));
+    int *next = (int *) malloc(t->n * sizeof(int));
+    int bad = 0;
+
+    for (int root = 0; root < t->n && bad == 0; root++) {
+        int depth = 0;
+
+        if (state[root] != 0 || (root > 0 && t->specs[root - 1].parent == t->specs[root].parent))
+            continue;
+        state[root] = 1;
+        first[0] = next[0] = root;
+        while (depth >= 0 && bad == 0) {
+            int i = next[depth];
+
+            if (i == t->n || t->specs[i].parent != t->specs[first[depth]].parent) {
+                state[first[depth--]] = 2;
+                continue;
+            }
+            next[depth]++;
+
+            int end, child = fork_find(t, t->specs[i].pid, &end);
+            if (child == end || state[child] == 2)
+                continue;
+            if (state[child] == 1) {
+                bad = t->specs[i].line;
+                break;
+            }
+            state[child] = 1;
+            depth++;
+            first[depth] = next[depth] = child;
+        }
+    }
+    free(state);
+    free(first);
+    free(next);
+    return bad;
+}
+
+/**
+ * Reads a fork file into t. Returns 0 on success, or the line number of
+ * the first malformed line, or of a spec forking an ancestor or beyond
+ * the burst of a forked parent.
+ */
+int fork_load(ForkTableType *t, FILE *f)
+{
+    ForkSpecType spec, *raw = NULL;
+    int n = 0, cap = 0, line = 0, got;
+
+    while ((got = fscanf(f, "%d %d %" SCNdTIME " %" SCNdTIME, &spec.pid, &spec.parent, &spec.at, &spec.bt)) != EOF) {
+        line++;
+        if (got != 4 || spec.at < 0 || spec.bt < 0 || spec.pid == spec.parent) {
+            free(raw);
+            return line;
+        }
+        spec.line = line;
+        if (n == cap) {
+            cap = cap ? 2 * cap : 64;
+            raw = (ForkSpecType *) realloc(raw, cap * sizeof(ForkSpecType));
+        }
+        raw[n++] = spec;
+    }
+
+    // Two stable passes: by fork point, then by parent
+    uint64_t *keys = (uint64_t *) malloc(n * sizeof(uint64_t));
+    int *order = (int *) malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        keys[i] = RADIX_KEY(raw[i].at);
+        order[i] = i;
+    }
+    radix_sort_index(keys, order, n, 0);
+    for (int i = 0; i < n; i++)
+        keys[i] = RADIX_KEY(raw[i].parent);
+    radix_sort_index(keys, order, n, 0);
+
+    t->n = n;
+    t->specs = (ForkSpecType *) malloc(n * sizeof(ForkSpecType));
+    for (int i = 0; i < n; i++)
+        t->specs[i] = raw[order[i]];
+
+    free(keys);
+    free(order);
+    free(raw);
+
+    int bad = fork_cycle(t);
+    for (int i = 0; i < n && bad == 0; i++)
+        bad = late_fork(t, t->specs[i].pid, t->specs[i].bt);
+    if (bad != 0)
+        fork_free(t);
+    return bad;
+}
+
+/**
+ * Checks the fork points of the n processes of a trace against their
+ * bursts. Returns 0, or the line of the first spec beyond one.
+ */
+int fork_check(const ForkTableType *t, const ProcessType *plist, int n)
+{
+    for (int i = 0; i < n; i++) {
+        int bad = late_fork(t, plist[i].pid, plist[i].bt);
+        if (bad != 0)
+            return bad;
+    }
+    return 0;
+}
+
+void fork_free(ForkTableType *t)
+{
+    free(t->specs);
+    t->specs = NULL;
+    t->n = 0;
+}
+
+/**
+ * Returns the index of the first spec forked by parent and sets *end
+ * one past its last; the range is empty when parent forks nothing
+ */
+int fork_find(const ForkTableType *t, int parent, int *end)
+{
+    int lo = 0, hi = t->n;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (t->specs[mid].parent < parent)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *end = lo;
+    while (*end < t->n && t->specs[*end].parent == parent)
+        (*end)++;
+    return lo;
+}
@@ -0,0 +1,40 @@
+#ifndef FORK_H
+#define FORK_H
+
+#include <stdio.h>
+#include "process.h"
+
+/**
+ * Process creation during a run. Each line of a fork file is
+ *   child_pid parent_pid at bt
+ * meaning that once the parent has run for at time units of its burst
+ * it creates the child with burst bt. Children inherit the parent's
+ * priority and tenant, may fork in turn, and a parent that finishes
+ * its burst waits for all of its children before it completes.
+ *
+ * A fork point must lie within the parent's burst, and no process may
+ * fork itself or one of its ancestors, which would never end.
+ * fork_load() checks both where the parent is itself forked, and
+ * fork_check() where it comes from a trace.
+ */
+
+typedef struct ForkSpec {
+    int pid;
+    int parent;
+    SimTimeType at;
+    SimTimeType bt;
+    int line;			// in the fork file
+} ForkSpecType;
+
+// Specs sorted by parent pid, then fork point, then file order
+typedef struct ForkTable {
+    ForkSpecType *specs;
+    int n;
+} ForkTableType;
+
+int fork_load(ForkTableType *, FILE *);
+int fork_check(const ForkTableType *, const ProcessType *, int);
+void fork_free(ForkTableType *);
+int fork_find(const ForkTableType *, int, int *);
+
+#endif				// FORK_H
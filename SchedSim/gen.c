@@ -0,0 +1,312 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mem.h"
+#include "process.h"
+#include "rng.h"
+#include "util.h"
+#include "workload.h"
+
+/**
+ * Synthetic workload generator. Fits the burst length, inter-arrival
+ * and priority distributions of a trace and writes an arbitrarily large
+ * workload with matching statistics in the text or binary format.
+ *
+ * Output is produced in blocks of BLOCK_RECORDS processes. Block b
+ * draws from the b-th jump of the seeded generator, so the output only
+ * depends on the seed, not on the number of threads. Each round the
+ * workers first draw their blocks, the arrival offsets are chained
+ * across blocks, then the workers format in parallel and the blocks
+ * are written in order with large sequential writes.
+ *
+ * An MMPP phase must carry across blocks. Its chain runs on a second
+ * set of block streams: each worker first finds the state its block
+ * ends in from either start state, those maps are chained serially,
+ * and the block is then drawn from its true start state.
+ */
+
+#define BLOCK_RECORDS (1L << 20)
+#define TEXT_RECORD_MAX 96
+#define PHASE_SALT 0x6a09e667f3bcc909ULL
+
+typedef struct Worker {
+    pthread_t tid;
+    const WorkloadModelType *model;
+    bool binary;
+    RngType rng;
+    RngType phase;
+    int state;
+    int end_state[2];
+    long first_pid;
+    long count;
+    SimTimeType base_art;
+    SimTimeType gap_sum;
+    SimTimeType *gap;
+    SimTimeType *bt;
+    int *pri;
+    char *buf;
+    size_t len;
+} WorkerType;
+
+// Both chains draw in lockstep, so once they meet one of them runs on alone
+static void *phase_block(void *arg)
+{
+    WorkerType *w = (WorkerType *) arg;
+    RngType r0 = w->phase, r1 = w->phase;
+    int s0 = 0, s1 = 1;
+    long i = 0;
+
+    for (; i < w->count && s0 != s1; i++) {
+        s0 = dist_step(&w->model->gap, &r0, s0);
+        s1 = dist_step(&w->model->gap, &r1, s1);
+    }
+    for (; i < w->count; i++)
+        s0 = s1 = dist_step(&w->model->gap, &r0, s0);
+    w->end_state[0] = s0;
+    w->end_state[1] = s1;
+    return NULL;
+}
+
+// Start state of each block against one serial run of the phase chain
+static int check_phases(const WorkerType *workers, int nthreads, int *state)
+{
+    for (int k = 0; k < nthreads && workers[k].count > 0; k++) {
+        RngType r = workers[k].phase;
+        if (workers[k].state != *state) {
+            printf("Error: MMPP block at pid %ld starts in state %d, the serial chain in %d\n",
+                   workers[k].first_pid, workers[k].state, *state);
+            return -1;
+        }
+        for (long i = 0; i < workers[k].count; i++)
+            *state = dist_step(&workers[k].model->gap, &r, *state);
+    }
+    return 0;
+}
+
+static void *generate_block(void *arg)
+{
+    WorkerType *w = (WorkerType *) arg;
+    bool mmpp = w->model->gap.kind == DIST_MMPP;
+    int state = w->state;
+
+    w->gap_sum = 0;
+    for (long i = 0; i < w->count; i++) {
+        if (mmpp) {
+            w->gap[i] = dist_sample_in(&w->model->gap, &w->rng, state);
+            state = dist_step(&w->model->gap, &w->phase, state);
+        } else {
+            w->gap[i] = dist_sample(&w->model->gap, &w->rng, NULL);
+        }
+        w->bt[i] = dist_sample(&w->model->burst, &w->rng, NULL);
+        w->pri[i] = dist_sample(&w->model->pri, &w->rng, NULL);
+        if (w->bt[i] < 1)
+            w->bt[i] = 1;
+        w->gap_sum += w->gap[i];
+    }
+    return NULL;
+}
+
+// The first process of the workload arrives at 0, later ones after their gap
+static void *format_block(void *arg)
+{
+    WorkerType *w = (WorkerType *) arg;
+    SimTimeType art = w->base_art;
+    char *out = w->buf;
+
+    for (long i = 0; i < w->count; i++) {
+        if (w->first_pid + i > 1)
+            art += w->gap[i];
+        if (w->binary) {
+            TraceRecordType rec = { (int32_t) (w->first_pid + i), w->pri[i], w->bt[i], art, 0, 0 };
+            memcpy(out, &rec, sizeof(rec));
+            out += sizeof(rec);
+        } else {
+            out += sprintf(out, "%ld %" PRIdTIME " %" PRIdTIME " 0 0 %d\n", w->first_pid + i, w->bt[i], art,
+                           w->pri[i]);
+        }
+    }
+    w->len = out - w->buf;
+    return NULL;
+}
+
+static void run_workers(WorkerType *workers, int nthreads, void *(*fn)(void *))
+{
+    for (int k = 0; k < nthreads; k++) {
+        if (workers[k].count > 0)
+            pthread_create(&workers[k].tid, NULL, fn, &workers[k]);
+    }
+    for (int k = 0; k < nthreads; k++) {
+        if (workers[k].count > 0)
+            pthread_join(workers[k].tid, NULL);
+    }
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [-n count] [-j threads] [-s seed] [-b burst_dist] [-i gap_dist]\n"
+           "          [-B] [-o output] [-v] [-c] trace_file\n"
+           "  burst_dist: empirical, exp, lognormal, pareto (default empirical)\n"
+           "  gap_dist:   empirical, exp, lognormal, pareto, mmpp (default empirical)\n"
+           "  -B writes the binary trace format, -v prints the fitted model,\n"
+           "  -c checks the MMPP block states against a serial run of the chain\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    long total = 1000;
+    int nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long long seed = 1;
+    DistKindType burst_kind = DIST_EMPIRICAL, gap_kind = DIST_EMPIRICAL;
+    bool binary = false, verbose = false, check = false;
+    const char *output = NULL;
+    int opt, n = 0;
+
+    while ((opt = getopt(argc, argv, "n:j:s:b:i:Bo:vc")) != -1) {
+        switch (opt) {
+        case 'n':
+            total = atol(optarg);
+            break;
+        case 'j':
+            nthreads = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'b':
+            if (dist_kind(optarg, &burst_kind) != 0 || burst_kind == DIST_MMPP) {
+                printf("Error: Unknown burst distribution %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'i':
+            if (dist_kind(optarg, &gap_kind) != 0) {
+                printf("Error: Unknown inter-arrival distribution %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'B':
+            binary = true;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        case 'c':
+            check = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || total < 1 || total > INT_MAX || nthreads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *trace = fopen(argv[optind], "r");
+    if (trace == NULL) {
+        printf("Error: Could not open file %s\n", argv[optind]);
+        return 1;
+    }
+    ProcessType *plist = parse_file(trace, &n);
+    fclose(trace);
+    if (plist == NULL || n == 0) {
+        printf("Error: No processes in %s\n", argv[optind]);
+        return 1;
+    }
+
+    WorkloadModelType model;
+    workload_fit(&model, plist, n, burst_kind, gap_kind);
+    mem_free(plist);
+    if (verbose) {
+        dist_print(stderr, "burst", &model.burst);
+        dist_print(stderr, "inter-arrival", &model.gap);
+        dist_print(stderr, "priority", &model.pri);
+    }
+
+    FILE *out = output ? fopen(output, "wb") : stdout;
+    if (out == NULL) {
+        printf("Error: Could not open file %s\n", output);
+        return 1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 22);
+    if (binary) {
+        TraceHeaderType hdr;
+        memcpy(hdr.magic, TRACE_MAGIC, 4);
+        hdr.version = TRACE_VERSION;
+        hdr.count = total;
+        fwrite(&hdr, sizeof(hdr), 1, out);
+    }
+
+    WorkerType *workers = (WorkerType *) calloc(nthreads, sizeof(WorkerType));
+    size_t record_max = binary ? sizeof(TraceRecordType) : TEXT_RECORD_MAX;
+    for (int k = 0; k < nthreads; k++) {
+        workers[k].model = &model;
+        workers[k].binary = binary;
+        workers[k].gap = (SimTimeType *) malloc(BLOCK_RECORDS * sizeof(SimTimeType));
+        workers[k].bt = (SimTimeType *) malloc(BLOCK_RECORDS * sizeof(SimTimeType));
+        workers[k].pri = (int *) malloc(BLOCK_RECORDS * sizeof(int));
+        workers[k].buf = (char *) malloc(BLOCK_RECORDS * record_max);
+    }
+
+    RngType stream, phases;
+    rng_seed(&stream, seed);
+    rng_seed(&phases, seed ^ PHASE_SALT);
+    long next_pid = 1;
+    SimTimeType art = 0;
+    int state = 0, serial_state = 0;
+
+    while (next_pid <= total) {
+        for (int k = 0; k < nthreads; k++) {
+            long left = total - next_pid + 1;
+            workers[k].count = left < BLOCK_RECORDS ? left : BLOCK_RECORDS;
+            workers[k].first_pid = next_pid;
+            workers[k].rng = stream;
+            workers[k].phase = phases;
+            rng_jump(&stream);
+            rng_jump(&phases);
+            next_pid += workers[k].count;
+        }
+        if (model.gap.kind == DIST_MMPP) {
+            run_workers(workers, nthreads, phase_block);
+            for (int k = 0; k < nthreads && workers[k].count > 0; k++) {
+                workers[k].state = state;
+                state = workers[k].end_state[state];
+            }
+            if (check && check_phases(workers, nthreads, &serial_state) != 0)
+                return 1;
+        }
+        run_workers(workers, nthreads, generate_block);
+
+        // Chain arrival times across blocks; the very first gap is unused
+        for (int k = 0; k < nthreads && workers[k].count > 0; k++) {
+            workers[k].base_art = art;
+            art += workers[k].gap_sum - (workers[k].first_pid == 1 ? workers[k].gap[0] : 0);
+        }
+        run_workers(workers, nthreads, format_block);
+
+        for (int k = 0; k < nthreads && workers[k].count > 0; k++)
+            fwrite(workers[k].buf, 1, workers[k].len, out);
+    }
+
+    if (out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+    for (int k = 0; k < nthreads; k++) {
+        free(workers[k].gap);
+        free(workers[k].bt);
+        free(workers[k].pri);
+        free(workers[k].buf);
+    }
+    free(workers);
+    workload_free(&model);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <stdlib.h>
+
+#include "heap.h"
+
+static int node_less(const HeapNodeType *a, const HeapNodeType *b)
+{
+    if (a->key != b->key)
+        return a->key < b->key;
+    if (a->tie != b->tie)
+        return (int32_t) (a->tie - b->tie) < 0;
+    return a->idx < b->idx;
+}
+
+void heap_init(HeapType *h, int cap)
+{
+    h->size = 0;
+    h->cap = cap > 0 ? cap : 16;
+    h->nodes = (HeapNodeType *) malloc(h->cap * sizeof(HeapNodeType));
+}
+
+void heap_free(HeapType *h)
+{
+    free(h->nodes);
+    h->nodes = NULL;
+    h->size = h->cap = 0;
+}
+
+void heap_push(HeapType *h, long key, int idx)
+{
+    heap_push_tie(h, key, 0, idx);
+}
+
+void heap_push_tie(HeapType *h, long key, uint32_t tie, int idx)
+{
+    int i = h->size++;
+
+    if (h->size > h->cap) {
+        h->cap *= 2;
+        h->nodes = (HeapNodeType *) realloc(h->nodes, h->cap * sizeof(HeapNodeType));
+    }
+
+    HeapNodeType node = { key, idx, tie };
+    while (i > 0 && node_less(&node, &h->nodes[(i - 1) / 2])) {
+        h->nodes[i] = h->nodes[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->nodes[i] = node;
+}
+
+// Removes and returns the smallest node; the heap must not be empty
+HeapNodeType heap_pop(HeapType *h)
+{
+    HeapNodeType top = h->nodes[0];
+    HeapNodeType last = h->nodes[--h->size];
+    int i = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= h->size)
+            break;
+        if (child + 1 < h->size && node_less(&h->nodes[child + 1], &h->nodes[child]))
+            child++;
+        if (!node_less(&h->nodes[child], &last))
+            break;
+        h->nodes[i] = h->nodes[child];
+        i = child;
+    }
+    if (h->size > 0)
+        h->nodes[i] = last;
+    return top;
+}
@@ -0,0 +1,33 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdint.h>
+
+/**
+ * Binary min-heap of (key, idx) pairs, used as the ready queue of the
+ * event driven schedulers. Equal keys are ordered by tie, then by idx,
+ * so results do not depend on insertion order. tie is a wrapping
+ * sequence number, which orders correctly while the ties in the heap
+ * span less than 2^31; heap_push() leaves it 0. The heap grows on
+ * demand.
+ */
+
+typedef struct HeapNode {
+    long key;
+    int idx;
+    uint32_t tie;
+} HeapNodeType;
+
+typedef struct Heap {
+    HeapNodeType *nodes;
+    int size;
+    int cap;
+} HeapType;
+
+void heap_init(HeapType *, int);
+void heap_free(HeapType *);
+void heap_push(HeapType *, long, int);
+void heap_push_tie(HeapType *, long, uint32_t, int);
+HeapNodeType heap_pop(HeapType *);
+
+#endif				// HEAP_H
@@ -0,0 +1,111 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "mem.h"
+
+// Keeps the table itself cache line aligned
+#define MEM_HEADER 64
+
+typedef struct MemHeader {
+    size_t bytes;		// of the mapping, 0 when from calloc
+} MemHeaderType;
+
+static HugeModeType huge_mode = HUGE_OFF;
+// Updated from extsort and radix worker threads
+static size_t huge_bytes;
+static long huge_fallbacks;
+
+void mem_set_huge(HugeModeType mode)
+{
+    huge_mode = mode;
+}
+
+// Parses off, thp or explicit. Returns 0 on success, -1 otherwise.
+int mem_parse_huge(const char *s, HugeModeType *mode)
+{
+    static const char *names[] = { "off", "thp", "explicit" };
+
+    for (int m = HUGE_OFF; m <= HUGE_EXPLICIT; m++) {
+        if (strcmp(s, names[m]) == 0) {
+            *mode = (HugeModeType) m;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Maps len bytes on a huge page boundary, or returns NULL
+static void *map_huge(size_t len)
+{
+    void *p;
+
+    if (huge_mode == HUGE_EXPLICIT) {
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            return p;
+        __atomic_add_fetch(&huge_fallbacks, 1, __ATOMIC_RELAXED);
+    }
+
+    // Over-map by one huge page and trim to an aligned range
+    char *raw = (char *) mmap(NULL, len + MEM_HUGE_PAGE, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    char *start = (char *) (((uintptr_t) raw + MEM_HUGE_PAGE - 1) & ~(MEM_HUGE_PAGE - 1));
+    if (start > raw)
+        munmap(raw, start - raw);
+    munmap(start + len, raw + MEM_HUGE_PAGE - start);
+    madvise(start, len, MADV_HUGEPAGE);
+    return start;
+}
+
+void *mem_alloc(size_t bytes)
+{
+    MemHeaderType *h = NULL;
+
+    if (huge_mode != HUGE_OFF && bytes >= MEM_HUGE_MIN) {
+        size_t len = (bytes + MEM_HEADER + MEM_HUGE_PAGE - 1) & ~(MEM_HUGE_PAGE - 1);
+        h = (MemHeaderType *) map_huge(len);
+        if (h != NULL) {
+            h->bytes = len;
+            __atomic_add_fetch(&huge_bytes, len, __ATOMIC_RELAXED);
+        }
+    }
+    if (h == NULL) {
+        h = (MemHeaderType *) calloc(1, bytes + MEM_HEADER);
+        if (h == NULL)
+            return NULL;
+        h->bytes = 0;
+    }
+    return (char *) h + MEM_HEADER;
+}
+
+void mem_free(void *p)
+{
+    if (p == NULL)
+        return;
+
+    MemHeaderType *h = (MemHeaderType *) ((char *) p - MEM_HEADER);
+    if (h->bytes == 0) {
+        free(h);
+        return;
+    }
+    __atomic_sub_fetch(&huge_bytes, h->bytes, __ATOMIC_RELAXED);
+    munmap(h, h->bytes);
+}
+
+// Bytes currently mapped for huge pages, whether or not the kernel
+// has backed them with huge pages yet
+size_t mem_huge_bytes(void)
+{
+    return __atomic_load_n(&huge_bytes, __ATOMIC_RELAXED);
+}
+
+// Explicit huge page mappings that fell back to transparent ones
+long mem_huge_fallbacks(void)
+{
+    return __atomic_load_n(&huge_fallbacks, __ATOMIC_RELAXED);
+}
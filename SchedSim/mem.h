@@ -0,0 +1,38 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stddef.h>
+
+/**
+ * Allocation of large tables: the process list, its per-policy copies
+ * and the sort and scheduler scratch arrays. With huge pages on, tables
+ * of MEM_HUGE_MIN bytes or more are mapped on 2 MB boundaries and
+ * backed by transparent huge pages, or by explicit ones from the
+ * hugetlb pool, which falls back to transparent pages when the pool is
+ * empty. This cuts TLB misses on random access into tables of 10^8
+ * processes. Smaller tables, and every table with huge pages off, come
+ * from calloc.
+ *
+ * Mapped pages are not touched by mem_alloc() beyond the first one, so
+ * each lands on the NUMA node of the thread that first writes it;
+ * scratch that a worker thread fills itself is thus local to it.
+ * Memory from mem_alloc() is zeroed and must be freed with mem_free().
+ */
+
+#define MEM_HUGE_PAGE ((size_t) 1 << 21)
+#define MEM_HUGE_MIN (4 * MEM_HUGE_PAGE)
+
+typedef enum HugeMode {
+    HUGE_OFF,
+    HUGE_THP,			// madvise(MADV_HUGEPAGE)
+    HUGE_EXPLICIT		// MAP_HUGETLB
+} HugeModeType;
+
+void mem_set_huge(HugeModeType);
+int mem_parse_huge(const char *, HugeModeType *);
+void *mem_alloc(size_t);
+void mem_free(void *);
+size_t mem_huge_bytes(void);
+long mem_huge_fallbacks(void);
+
+#endif				// MEM_H
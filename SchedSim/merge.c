@@ -0,0 +1,127 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include "merge.h"
+#include "engine.h"
+#include "process.h"
+#include "util.h"
+
+static bool stream_less(const MergeType *m, int a, int b)
+{
+    return m->keys[a] < m->keys[b] || (m->keys[a] == m->keys[b] && a < b);
+}
+
+// Reads the next record of stream s into its head
+static void stream_advance(MergeType *m, int s)
+{
+    long prev = m->keys[s];
+
+    if (!trace_read(&m->readers[s], &m->heads[s])) {
+        m->keys[s] = LONG_MAX;
+        return;
+    }
+    m->keys[s] = m->heads[s].art;
+    if (m->keys[s] < prev && prev != LONG_MAX && !m->unsorted)
+        m->unsorted = s + 1;
+    if (m->tag) {
+        m->heads[s].tenant = s;
+        if (m->k > 1) {
+            long long pid = (long long) m->heads[s].pid * m->k + s;
+            if (pid >= INT_MIN && pid <= INT_MAX)
+                m->heads[s].pid = (int) pid;
+            else if (!m->overflow)
+                m->overflow = s + 1;
+        }
+    }
+}
+
+/**
+ * Leaves sit at positions k..2k-1 of an implicit binary tree; every
+ * internal node keeps the loser of the match played there and passes
+ * the winner up
+ */
+static int build(MergeType *m, int node)
+{
+    if (node >= m->k)
+        return node - m->k;
+
+    int a = build(m, 2 * node);
+    int b = build(m, 2 * node + 1);
+    if (stream_less(m, a, b)) {
+        m->tree[node] = b;
+        return a;
+    }
+    m->tree[node] = a;
+    return b;
+}
+
+// Replays the path of the previous winner after its key changed
+static void replay(MergeType *m)
+{
+    int w = m->tree[0];
+
+    for (int node = (w + m->k) / 2; node > 0; node /= 2) {
+        if (stream_less(m, m->tree[node], w)) {
+            int loser = w;
+            w = m->tree[node];
+            m->tree[node] = loser;
+        }
+    }
+    m->tree[0] = w;
+}
+
+/**
+ * Starts merging k opened readers. The readers stay owned by the
+ * caller and must outlive the merge. With k = 0 the merge is empty.
+ */
+void merge_init(MergeType *m, TraceReaderType *readers, int k, bool tag)
+{
+    m->k = k;
+    m->readers = readers;
+    m->heads = (ProcessType *) malloc(k * sizeof(ProcessType));
+    m->keys = (long *) malloc(k * sizeof(long));
+    m->tree = (int *) malloc((k > 0 ? k : 1) * sizeof(int));
+    m->tag = tag;
+    m->unsorted = 0;
+    m->overflow = 0;
+
+    for (int s = 0; s < k; s++) {
+        m->keys[s] = LONG_MAX;
+        stream_advance(m, s);
+    }
+    m->tree[0] = k > 0 ? build(m, 1) : -1;
+}
+
+static bool merge_peek(SourceType *src, ProcessType *p)
+{
+    MergeType *m = (MergeType *) src->state;
+    int w = m->tree[0];
+
+    if (w < 0 || m->keys[w] == LONG_MAX)
+        return false;
+    *p = m->heads[w];
+    return true;
+}
+
+static void merge_pop(SourceType *src)
+{
+    MergeType *m = (MergeType *) src->state;
+
+    stream_advance(m, m->tree[0]);
+    replay(m);
+}
+
+void merge_source(SourceType *src, MergeType *m)
+{
+    src->peek = merge_peek;
+    src->pop = merge_pop;
+    src->complete = NULL;
+    src->state = m;
+}
+
+void merge_free(MergeType *m)
+{
+    free(m->heads);
+    free(m->keys);
+    free(m->tree);
+}
@@ -0,0 +1,37 @@
+#ifndef MERGE_H
+#define MERGE_H
+
+#include <stdbool.h>
+#include "engine.h"
+#include "process.h"
+#include "util.h"
+
+/**
+ * K-way merge of arrival-sorted trace streams through a loser tree.
+ * Each step costs one leaf-to-root replay (log2 k comparisons, one per
+ * level, against the stored losers) and no heap sift. Equal arrival
+ * times come out in stream order.
+ *
+ * With tag set every process is stamped with its stream index as the
+ * tenant, and when there is more than one stream pids are remapped to
+ * pid * k + stream so that pids from different streams cannot collide.
+ * A pid whose remapped value does not fit an int is left as it is and
+ * the stream is reported in overflow.
+ */
+
+typedef struct Merge {
+    int k;
+    TraceReaderType *readers;
+    ProcessType *heads;
+    long *keys;			// head arrival time, LONG_MAX once a stream is done
+    int *tree;			// tree[0] is the winner, tree[1..k-1] the losers
+    bool tag;
+    int unsorted;		// index + 1 of the first stream found out of order
+    int overflow;		// index + 1 of the first stream with a pid too large to remap
+} MergeType;
+
+void merge_init(MergeType *, TraceReaderType *, int, bool);
+void merge_source(SourceType *, MergeType *);
+void merge_free(MergeType *);
+
+#endif				// MERGE_H
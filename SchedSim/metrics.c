@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "metrics.h"
+#include "process.h"
+
+/**
+ * Maps a non-negative sample to its histogram bucket. Values are kept
+ * with 1/STAT_SUB resolution; the first 2*STAT_SUB buckets are linear,
+ * after that every power of two is split into STAT_SUB buckets.
+ */
+static int stat_bucket(double v)
+{
+    double scaled = v * STAT_SUB;
+    unsigned long long u;
+
+    if (scaled <= 0)
+        return 0;
+    if (scaled >= 9.2e18)
+        return STAT_BUCKETS - 1;
+    u = (unsigned long long) scaled;
+    if (u < 2 * STAT_SUB)
+        return (int) u;
+
+    int e = 63 - __builtin_clzll(u);
+    int shift = e - STAT_SUB_BITS;
+    return (shift + 1) * STAT_SUB + (int) ((u >> shift) - STAT_SUB);
+}
+
+// Lower edge of a histogram bucket, in sample units
+static double stat_bucket_low(int b)
+{
+    if (b < 2 * STAT_SUB)
+        return (double) b / STAT_SUB;
+
+    int shift = b / STAT_SUB - 1;
+    double u = (double) (STAT_SUB + b % STAT_SUB) * (double) (1ULL << shift);
+    return u / STAT_SUB;
+}
+
+void stat_add(StatType *s, double v)
+{
+    s->n++;
+    s->sum += v;
+    s->sumsq += v * v;
+    if (v > s->max)
+        s->max = v;
+    s->hist[stat_bucket(v)]++;
+}
+
+double stat_mean(const StatType *s)
+{
+    return s->n ? s->sum / s->n : 0.0;
+}
+
+/**
+ * Returns the p-th quantile (0 < p <= 1) as the lower edge of the bucket
+ * holding it, capped at the maximum. Each bucket spans 1/STAT_SUB of its
+ * power of two, so the result may be up to that fraction (~6%) below the
+ * true value; integer samples are only exact below 2 * STAT_SUB, e.g. a
+ * response time of 73 is reported as 72.
+ */
+double stat_percentile(const StatType *s, double p)
+{
+    unsigned long rank, seen = 0;
+
+    if (s->n == 0)
+        return 0.0;
+    rank = (unsigned long) (p * s->n + 0.999999);
+    if (rank < 1)
+        rank = 1;
+
+    for (int b = 0; b < STAT_BUCKETS; b++) {
+        seen += s->hist[b];
+        if (seen >= rank) {
+            double v = stat_bucket_low(b);
+            return v < s->max ? v : s->max;
+        }
+    }
+    return s->max;
+}
+
+// Jain's fairness index: (sum x)^2 / (n * sum x^2), 1.0 is perfectly fair
+double stat_jain(const StatType *s)
+{
+    if (s->n == 0 || s->sumsq == 0)
+        return 1.0;
+    return (s->sum * s->sum) / (s->n * s->sumsq);
+}
+
+void metrics_init(MetricsType *m)
+{
+    memset(m, 0, sizeof(*m));
+}
+
+int metrics_class(int pri)
+{
+    if (pri < 0)
+        return 0;
+    if (pri >= NUM_PRI_CLASSES)
+        return NUM_PRI_CLASSES - 1;
+    return pri;
+}
+
+int metrics_tenant(int tenant)
+{
+    if (tenant < 0)
+        return 0;
+    if (tenant >= NUM_TENANTS)
+        return NUM_TENANTS - 1;
+    return tenant;
+}
+
+/**
+ * Accounts one finished process. Slowdown is tat/bt; zero-length bursts
+ * are treated as one time unit so the ratio stays bounded.
+ */
+void metrics_add(MetricsType *m, const ProcessType *p)
+{
+    int c = metrics_class(p->pri);
+    int t = metrics_tenant(p->tenant);
+    double slowdown = (double) p->tat / (p->bt > 0 ? p->bt : 1);
+
+    m->n++;
+    m->total_wt += p->wt;
+    m->total_tat += p->tat;
+    m->total_rt += p->rt;
+    m->total_weighted_tat += (long) (p->pri + 1) * p->tat;
+    stat_add(&m->slowdown, slowdown);
+    stat_add(&m->response, p->rt);
+
+    m->cls_wt[c] += p->wt;
+    m->cls_tat[c] += p->tat;
+    m->cls_rt[c] += p->rt;
+    stat_add(&m->cls_slowdown[c], slowdown);
+
+    m->ten_n[t]++;
+    m->ten_wt[t] += p->wt;
+    m->ten_tat[t] += p->tat;
+    m->ten_rt[t] += p->rt;
+}
+
+// Human readable fairness section, printed below the averages
+void metrics_print(const MetricsType *m)
+{
+    const StatType *s = &m->slowdown;
+    const StatType *r = &m->response;
+
+    printf("Average response time = %.2f\n", stat_mean(r));
+    printf("Response time p50/p95/p99/max = %.2f/%.2f/%.2f/%.2f\n",
+           stat_percentile(r, 0.50), stat_percentile(r, 0.95),
+           stat_percentile(r, 0.99), r->max);
+    printf("Average slowdown = %.2f\n", stat_mean(s));
+    printf("Max slowdown = %.2f\n", s->max);
+    printf("Slowdown p50/p95/p99 = %.2f/%.2f/%.2f\n",
+           stat_percentile(s, 0.50), stat_percentile(s, 0.95), stat_percentile(s, 0.99));
+    printf("Jain's fairness index (slowdown) = %.3f\n", stat_jain(s));
+
+    printf("\tPriority class\tProcesses\tAvg waiting time\tAvg response time\tAvg slowdown\tMax slowdown\n");
+    for (int c = 0; c < NUM_PRI_CLASSES; c++) {
+        const StatType *cs = &m->cls_slowdown[c];
+        if (cs->n == 0)
+            continue;
+        printf("\t%d%s\t\t%ld\t\t%.2f\t\t\t%.2f\t\t\t%.2f\t\t%.2f\n", c,
+               c == NUM_PRI_CLASSES - 1 ? "+" : "", cs->n,
+               (double) m->cls_wt[c] / cs->n, (double) m->cls_rt[c] / cs->n,
+               stat_mean(cs), cs->max);
+    }
+
+    // Single-tenant runs (every plain input file) skip the tenant table
+    if (m->ten_n[0] == m->n)
+        return;
+    printf("\tTenant\t\tProcesses\tAvg waiting time\tAvg turn around time\tAvg response time\n");
+    for (int t = 0; t < NUM_TENANTS; t++) {
+        if (m->ten_n[t] == 0)
+            continue;
+        printf("\t%d%s\t\t%ld\t\t%.2f\t\t\t%.2f\t\t\t%.2f\n", t,
+               t == NUM_TENANTS - 1 ? "+" : "", m->ten_n[t],
+               (double) m->ten_wt[t] / m->ten_n[t], (double) m->ten_tat[t] / m->ten_n[t],
+               (double) m->ten_rt[t] / m->ten_n[t]);
+    }
+}
+
+void metrics_csv_header(FILE *f)
+{
+    fprintf(f, "policy,class,processes,avg_wt,avg_tat,avg_slowdown,max_slowdown,"
+            "p50_slowdown,p95_slowdown,p99_slowdown,jain_slowdown,"
+            "avg_rt,p50_rt,p95_rt,p99_rt,max_rt\n");
+}
+
+static void metrics_csv_row(FILE *f, const char *policy, const char *cls,
+                            long n, long wt, long tat, const StatType *s,
+                            long rt, const StatType *r)
+{
+    fprintf(f, "%s,%s,%ld,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f",
+            policy, cls, n, (double) wt / n, (double) tat / n,
+            stat_mean(s), s->max, stat_percentile(s, 0.50),
+            stat_percentile(s, 0.95), stat_percentile(s, 0.99), stat_jain(s));
+    // Response time percentiles are only tracked for the whole run
+    if (r != NULL)
+        fprintf(f, ",%.4f,%.4f,%.4f,%.4f,%.4f\n", (double) rt / n,
+                stat_percentile(r, 0.50), stat_percentile(r, 0.95),
+                stat_percentile(r, 0.99), r->max);
+    else
+        fprintf(f, ",%.4f,,,,\n", (double) rt / n);
+}
+
+/**
+ * Machine readable summary: one "all" row followed by one row for each
+ * priority class that has processes
+ */
+void metrics_csv(FILE *f, const char *policy, const MetricsType *m)
+{
+    char cls[16];
+
+    if (m->n == 0)
+        return;
+    metrics_csv_row(f, policy, "all", m->n, m->total_wt, m->total_tat, &m->slowdown,
+                    m->total_rt, &m->response);
+    for (int c = 0; c < NUM_PRI_CLASSES; c++) {
+        if (m->cls_slowdown[c].n == 0)
+            continue;
+        snprintf(cls, sizeof(cls), "%d", c);
+        metrics_csv_row(f, policy, cls, m->cls_slowdown[c].n,
+                        m->cls_wt[c], m->cls_tat[c], &m->cls_slowdown[c],
+                        m->cls_rt[c], NULL);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include "process.h"
+
+/**
+ * Streaming scheduling metrics. Every findavgTime* path feeds each
+ * finished process into metrics_add() from the same loop that computes
+ * its turnaround time, so no extra pass over plist is needed.
+ */
+
+#define NUM_PRI_CLASSES 16	// priorities >= NUM_PRI_CLASSES-1 share the last class
+#define NUM_TENANTS 16		// tenants >= NUM_TENANTS-1 share the last row
+
+#define STAT_SUB_BITS 4		// 16 sub-buckets per power of two: percentiles up to ~6% low
+#define STAT_SUB (1 << STAT_SUB_BITS)
+#define STAT_BUCKETS ((64 - STAT_SUB_BITS) * STAT_SUB)
+
+/**
+ * Running summary of one sample stream: count, sum, sum of squares,
+ * maximum and a log-bucketed histogram used for percentiles
+ */
+typedef struct Stat {
+    long n;
+    double sum;
+    double sumsq;
+    double max;
+    unsigned long hist[STAT_BUCKETS];
+} StatType;
+
+typedef struct Metrics {
+    long n;
+    long total_wt;
+    long total_tat;
+    long total_rt;
+    long total_weighted_tat;	// sum of (pri + 1) * tat
+    StatType slowdown;
+    StatType response;
+    long cls_wt[NUM_PRI_CLASSES];
+    long cls_tat[NUM_PRI_CLASSES];
+    long cls_rt[NUM_PRI_CLASSES];
+    StatType cls_slowdown[NUM_PRI_CLASSES];
+    long ten_n[NUM_TENANTS];
+    long ten_wt[NUM_TENANTS];
+    long ten_tat[NUM_TENANTS];
+    long ten_rt[NUM_TENANTS];
+    // Dispatch decisions of an engine run and what they cost
+    long decisions;
+    long decision_queue;	// sum of ready queue lengths seen
+    long overhead;		// CPU time charged for them
+    // Source arrivals under admission control
+    long admitted;
+    long rejected;		// turned away on arrival
+    long dropped;		// admitted, then dropped while waiting
+} MetricsType;
+
+void stat_add(StatType *, double);
+double stat_mean(const StatType *);
+double stat_percentile(const StatType *, double);
+double stat_jain(const StatType *);
+
+void metrics_init(MetricsType *);
+void metrics_add(MetricsType *, const ProcessType *);
+int metrics_class(int pri);
+int metrics_tenant(int tenant);
+
+void metrics_print(const MetricsType *);
+void metrics_csv_header(FILE *);
+void metrics_csv(FILE *, const char *, const MetricsType *);
+
+#endif				// METRICS_H
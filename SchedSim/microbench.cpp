@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+#include "sched.hpp"
+
+extern "C" {
+#include "heap.h"
+#include "mem.h"
+#include "metrics.h"
+#include "report.h"
+#include "rng.h"
+#include "sched.h"
+#include "util.h"
+}
+
+/**
+ * Microbenchmarks of single kernels, so an optimisation can be judged
+ * without the rest of a run around it. Each kernel runs warmup times
+ * untimed, then reps timed samples; the report gives the mean with a
+ * normal 95% confidence interval, the standard deviation, minimum and
+ * median per sample, and the mean per process. Kernels whose name does
+ * not contain the filter argument are skipped.
+ */
+
+struct Workload {
+    std::vector<ProcessType> plist;
+    std::vector<ProcessType> work;
+    std::vector<ProcessType> shuffled;	// plist lightly shuffled, as real traces are
+    std::vector<int> order;
+    std::vector<long> keys;		// random queue keys
+    std::vector<char> text;		// plist as a text trace
+    std::vector<char> binary;		// plist as a binary trace
+    MetricsType *m;
+    int n;
+};
+
+static double now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Poisson arrivals at about 90% load, exponential bursts, as schedbench
+static void make_workload(Workload &w, int n, RngType *rng)
+{
+    long art = 0;
+
+    w.n = n;
+    w.plist.resize(n);
+    w.work.resize(n);
+    w.order.resize(n);
+    w.keys.resize(n);
+    for (int i = 0; i < n; i++) {
+        ProcessType &p = w.plist[i];
+        std::memset(&p, 0, sizeof(p));
+        art += std::lround(rng_exp(rng, 10.0));
+        p.pid = i + 1;
+        p.art = art;
+        p.bt = 1 + std::lround(rng_exp(rng, 8.0));
+        p.pri = (int) (rng_next(rng) % 16);
+        w.keys[i] = (long) (rng_next(rng) % 1000000);
+    }
+    std::memcpy(w.work.data(), w.plist.data(), n * sizeof(ProcessType));
+
+    // Arrival traces from several hosts are only nearly sorted; n / 100
+    // random swaps, like schedbench's arrival keys
+    w.shuffled = w.plist;
+    for (int i = 0; i < n / 100; i++) {
+        int a = (int) (rng_next(rng) % n), b = (int) (rng_next(rng) % n);
+        std::swap(w.shuffled[a], w.shuffled[b]);
+    }
+
+    char line[128];
+    w.text.clear();
+    for (const ProcessType &p : w.plist) {
+        int len = std::snprintf(line, sizeof(line),
+                                "%d %" PRIdTIME " %" PRIdTIME " %" PRIdTIME " %" PRIdTIME " %d\n",
+                                p.pid, p.bt, p.art, p.wt, p.tat, p.pri);
+        w.text.insert(w.text.end(), line, line + len);
+    }
+
+    TraceHeaderType hdr;
+    std::memcpy(hdr.magic, TRACE_MAGIC, 4);
+    hdr.version = TRACE_VERSION;
+    hdr.count = n;
+    w.binary.assign((char *) &hdr, (char *) &hdr + sizeof(hdr));
+    for (const ProcessType &p : w.plist) {
+        TraceRecordType rec;
+        trace_record(&rec, &p);
+        w.binary.insert(w.binary.end(), (char *) &rec, (char *) &rec + sizeof(rec));
+    }
+}
+
+static void parse(std::vector<char> &trace)
+{
+    FILE *f = fmemopen(trace.data(), trace.size(), "r");
+    int n = 0;
+
+    mem_free(parse_file(f, &n));
+    std::fclose(f);
+}
+
+// Pushes every key, then pops until empty
+template <class Queue>
+static void fill_drain(Workload &w)
+{
+    Queue q(w.n);
+    long sum = 0;
+
+    for (int i = 0; i < w.n; i++)
+        q.push(w.keys[i], i);
+    while (!q.empty())
+        sum += q.pop();
+    if (sum < 0)
+        std::abort();
+}
+
+// heap.h's binary heap, as used by the C schedulers and the engine
+struct CHeapQueue {
+    explicit CHeapQueue(int n) { heap_init(&heap, n); }
+    ~CHeapQueue() { heap_free(&heap); }
+    bool empty() const { return heap.size == 0; }
+    void push(long key, int idx) { heap_push(&heap, key, idx); }
+    int pop() { return heap_pop(&heap).idx; }
+
+    HeapType heap;
+};
+
+// Runs fn with stdout sent to /dev/null
+template <class Fn>
+static void quietly(Fn fn)
+{
+    std::fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+
+    dup2(null, STDOUT_FILENO);
+    close(null);
+    fn();
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+struct Kernel {
+    const char *name;
+    void (*run)(Workload &);
+};
+
+static const Kernel kernels[] = {
+    { "parse_text", [](Workload &w) { parse(w.text); } },
+    { "parse_binary", [](Workload &w) { parse(w.binary); } },
+    { "queue_heap_c", fill_drain<CHeapQueue> },
+    { "queue_heap_cxx", fill_drain<sched::HeapQueue> },
+    { "queue_rank", fill_drain<sched::RankQueue> },
+    { "queue_fifo", fill_drain<sched::FifoQueue> },
+    { "sort_arrival", [](Workload &w) { sort_by_arrival(w.shuffled.data(), w.n, w.order.data()); } },
+    { "fcfs_recurrence", [](Workload &w) { findWaitingTimeFCFS(w.work.data(), nullptr, w.n); } },
+    { "metrics_aggregate", [](Workload &w) { findTurnAroundTime(w.work.data(), w.n, w.m); } },
+    { "print_metrics",
+      [](Workload &w) { quietly([&] { printMetrics(w.work.data(), nullptr, w.n, w.m); }); } },
+};
+
+static void usage(const char *prog)
+{
+    std::printf("Usage: %s [-n processes] [-w warmup] [-r repetitions] [-s seed] [filter]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 100000, warmup = 3, reps = 20;
+    unsigned long long seed = 1;
+    const char *filter = "";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:r:s:")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = std::atoi(optarg);
+            break;
+        case 'w':
+            warmup = std::atoi(optarg);
+            break;
+        case 'r':
+            reps = std::atoi(optarg);
+            break;
+        case 's':
+            seed = std::strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind < argc)
+        filter = argv[optind];
+    if (n < 1 || warmup < 0 || reps < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Workload w;
+    RngType rng;
+    std::vector<double> t(reps);
+
+    rng_seed(&rng, seed);
+    make_workload(w, n, &rng);
+    w.m = (MetricsType *) std::malloc(sizeof(MetricsType));
+    metrics_init(w.m);
+    // The recurrence fills in wt for the kernels after it
+    findWaitingTimeFCFS(w.work.data(), nullptr, n);
+
+    std::printf("%-18s %10s %11s %9s %9s %10s %10s %9s\n", "kernel", "n", "mean us", "+-95%",
+                "sd us", "min us", "median us", "ns/proc");
+    for (const Kernel &k : kernels) {
+        if (std::strstr(k.name, filter) == NULL)
+            continue;
+
+        for (int r = 0; r < warmup; r++)
+            k.run(w);
+        for (int r = 0; r < reps; r++) {
+            metrics_init(w.m);
+            double start = now();
+            k.run(w);
+            t[r] = (now() - start) * 1e6;
+        }
+
+        double mean = 0, var = 0;
+        for (double x : t)
+            mean += x;
+        mean /= reps;
+        for (double x : t)
+            var += (x - mean) * (x - mean);
+        double sd = std::sqrt(var / (reps - 1));
+        std::sort(t.begin(), t.end());
+        double median = reps % 2 ? t[reps / 2] : (t[reps / 2 - 1] + t[reps / 2]) / 2;
+
+        std::printf("%-18s %10d %11.1f %9.1f %9.1f %10.1f %10.1f %9.2f\n", k.name, n, mean,
+                    1.96 * sd / std::sqrt((double) reps), sd, t[0], median, mean * 1e3 / n);
+    }
+
+    std::free(w.m);
+    return 0;
+}
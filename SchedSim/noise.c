@@ -0,0 +1,114 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "noise.h"
+#include "process.h"
+#include "rng.h"
+
+// Reads "at len" lines into n. Returns 0, or the first bad line.
+static int load_replay(NoiseType *n, FILE *f)
+{
+    SimTimeType at, len, prev = 0;
+    long cap = 0;
+    int line = 0, got;
+
+    while ((got = fscanf(f, "%" SCNdTIME " %" SCNdTIME, &at, &len)) != EOF) {
+        line++;
+        if (got != 2 || at < prev || len < 0)
+            return line;
+        if (n->replay_n == cap) {
+            cap = cap ? 2 * cap : 256;
+            n->replay = (SimTimeType *) realloc(n->replay, 2 * cap * sizeof(SimTimeType));
+        }
+        n->replay[2 * n->replay_n] = at;
+        n->replay[2 * n->replay_n + 1] = len;
+        n->replay_n++;
+        prev = at;
+    }
+    return 0;
+}
+
+/**
+ * Sets up n from a spec: periodic:period,cost, poisson:mean_gap,cost or
+ * replay:file. Returns 0 on success, -1 for a bad spec or unreadable
+ * file, or the line number of the first malformed replay line.
+ */
+int noise_init(NoiseType *n, const char *spec, uint64_t seed)
+{
+    memset(n, 0, sizeof(*n));
+    n->seed = seed;
+
+    if (strncmp(spec, "replay:", 7) == 0) {
+        FILE *f = fopen(spec + 7, "r");
+        int bad;
+
+        if (f == NULL)
+            return -1;
+        n->kind = NOISE_REPLAY;
+        bad = load_replay(n, f);
+        fclose(f);
+        if (bad != 0)
+            noise_free(n);
+        return bad;
+    }
+
+    if (strncmp(spec, "periodic:", 9) == 0) {
+        n->kind = NOISE_PERIODIC;
+        spec += 9;
+    } else if (strncmp(spec, "poisson:", 8) == 0) {
+        n->kind = NOISE_POISSON;
+        spec += 8;
+    } else {
+        return -1;
+    }
+    // Noise that needs the whole CPU would never let a process run
+    if (sscanf(spec, "%" SCNdTIME ",%" SCNdTIME, &n->gap, &n->cost) != 2 || n->gap < 1 || n->cost < 0
+        || n->cost >= n->gap)
+        return -1;
+    return 0;
+}
+
+void noise_free(NoiseType *n)
+{
+    free(n->replay);
+    n->replay = NULL;
+    n->replay_n = 0;
+}
+
+// Restarts the stream so every policy sees the same noise
+void noise_rewind(NoiseType *n)
+{
+    rng_seed(&n->rng, n->seed);
+    n->next = 0;
+    n->at = 0;
+    n->events = 0;
+    n->stolen = 0;
+    noise_advance(n);
+}
+
+// Moves to the next event; a replay that has run out never fires again
+void noise_advance(NoiseType *n)
+{
+    switch (n->kind) {
+    case NOISE_PERIODIC:
+        n->at += n->gap;
+        n->len = n->cost;
+        break;
+    case NOISE_POISSON:
+        n->at += llround(rng_exp(&n->rng, (double) n->gap));
+        n->len = n->cost;
+        break;
+    case NOISE_REPLAY:
+        if (n->next < n->replay_n) {
+            n->at = n->replay[2 * n->next];
+            n->len = n->replay[2 * n->next + 1];
+            n->next++;
+        } else {
+            n->at = INT64_MAX;
+            n->len = 0;
+        }
+        break;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <stdint.h>
+#include "process.h"
+#include "rng.h"
+
+/**
+ * OS noise: timer ticks, IRQs and kernel threads that take the CPU
+ * from whatever process is running. A noise stream is a sequence of
+ * (at, len) events, either periodic, Poisson with a given mean gap, or
+ * replayed from a jitter trace of "at len" lines sorted by at. The
+ * engine merges the stream into its event loop: an event that falls
+ * inside a slice cuts it, the CPU is lost for len, and events arriving
+ * while another is being served queue behind it. Events during idle
+ * time only matter if they are still running when work arrives, so the
+ * cost is per noise event, never per unit of simulated time.
+ */
+
+typedef enum NoiseKind {
+    NOISE_PERIODIC,
+    NOISE_POISSON,
+    NOISE_REPLAY,
+} NoiseKindType;
+
+typedef struct Noise {
+    NoiseKindType kind;
+    SimTimeType gap;		// period, or mean gap for Poisson
+    SimTimeType cost;		// CPU time taken by each event
+    SimTimeType *replay;	// at, len pairs
+    long replay_n;
+    uint64_t seed;
+    // Stream position, restarted by noise_rewind()
+    RngType rng;
+    long next;
+    SimTimeType at;		// pending event
+    SimTimeType len;
+    long events;		// served so far
+    SimTimeType stolen;
+} NoiseType;
+
+int noise_init(NoiseType *, const char *, uint64_t);
+void noise_free(NoiseType *);
+void noise_rewind(NoiseType *);
+void noise_advance(NoiseType *);
+
+#endif				// NOISE_H
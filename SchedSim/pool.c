@@ -0,0 +1,69 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+void pool_init(PoolType *p, size_t size)
+{
+    memset(p, 0, sizeof(*p));
+    p->size = size < sizeof(int) ? sizeof(int) : size;
+    p->free_head = -1;
+}
+
+static void add_chunk(PoolType *p)
+{
+    if (p->num_chunks == p->chunk_cap) {
+        p->chunk_cap = p->chunk_cap ? 2 * p->chunk_cap : 16;
+        p->chunks = (char **) realloc(p->chunks, p->chunk_cap * sizeof(char *));
+        p->stats.mallocs++;
+    }
+    p->chunks[p->num_chunks++] = (char *) malloc(POOL_CHUNK * p->size);
+    p->stats.mallocs++;
+}
+
+// Returns the number of a fresh object; its contents are undefined
+int pool_alloc(PoolType *p)
+{
+    int i;
+
+    if (p->free_head >= 0) {
+        i = p->free_head;
+        memcpy(&p->free_head, POOL_AT(p, i), sizeof(int));
+    } else {
+        // Chunks kept by a reset are reused before new ones are added
+        if (p->used == p->num_chunks * POOL_CHUNK)
+            add_chunk(p);
+        i = p->used++;
+    }
+
+    p->stats.allocs++;
+    if (++p->stats.live > p->stats.peak)
+        p->stats.peak = p->stats.live;
+    return i;
+}
+
+void pool_free(PoolType *p, int i)
+{
+    memcpy(POOL_AT(p, i), &p->free_head, sizeof(int));
+    p->free_head = i;
+    p->stats.frees++;
+    p->stats.live--;
+}
+
+void pool_reset(PoolType *p)
+{
+    p->used = 0;
+    p->free_head = -1;
+    p->stats.frees += p->stats.live;
+    p->stats.live = 0;
+    p->stats.resets++;
+}
+
+void pool_destroy(PoolType *p)
+{
+    for (int c = 0; c < p->num_chunks; c++)
+        free(p->chunks[c]);
+    free(p->chunks);
+    p->chunks = NULL;
+    p->num_chunks = p->chunk_cap = 0;
+}
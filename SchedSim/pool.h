@@ -0,0 +1,48 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+/**
+ * Fixed-size object pool. Objects are numbered and live in chunks of
+ * POOL_CHUNK objects that never move, so a number stays valid while
+ * the pool grows and can be stored in queues instead of a pointer.
+ * Freed objects go on an intrusive free list and are reused first.
+ * pool_reset() frees every object at once but keeps the chunks, so a
+ * pool reused for run after run stops calling malloc once it has
+ * reached the peak size. A pool is not locked; each thread uses its
+ * own.
+ */
+
+#define POOL_CHUNK_BITS 10
+#define POOL_CHUNK (1 << POOL_CHUNK_BITS)
+
+#define POOL_AT(p, i) \
+    ((void *) ((p)->chunks[(i) >> POOL_CHUNK_BITS] + (size_t) ((i) & (POOL_CHUNK - 1)) * (p)->size))
+
+typedef struct PoolStats {
+    long allocs;
+    long frees;
+    long live;
+    long peak;			// most objects live at once
+    long resets;
+    long mallocs;		// calls to the system allocator, chunks and chunk table
+} PoolStatsType;
+
+typedef struct Pool {
+    size_t size;		// object size, at least sizeof(int)
+    char **chunks;
+    int num_chunks;
+    int chunk_cap;		// entries in chunks
+    int used;			// objects handed out from the chunks since the last reset
+    int free_head;		// -1 when the free list is empty
+    PoolStatsType stats;
+} PoolType;
+
+void pool_init(PoolType *, size_t);
+int pool_alloc(PoolType *);
+void pool_free(PoolType *, int);
+void pool_reset(PoolType *);
+void pool_destroy(PoolType *);
+
+#endif				// POOL_H
@@ -1,15 +1,27 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <inttypes.h>
+
+/**
+ * Simulated time, in the unit of the trace. 64 bits hold nanosecond
+ * traces for centuries, and since every scheduler advances from event
+ * to event rather than tick by tick, a finer unit costs nothing.
+ */
+typedef int64_t SimTimeType;
+
+#define PRIdTIME PRId64
+#define SCNdTIME SCNd64
+
 typedef struct Process { 
     int pid; // Process ID 
-    int bt; // Burst Time 
-    int art; // Arrival Time 
-    int wt; // waiting time
-    int tat; // turnaround time
     int pri; // priority
+    SimTimeType bt; // Burst Time 
+    SimTimeType art; // Arrival Time 
+    SimTimeType wt; // waiting time
+    SimTimeType tat; // turnaround time
+    SimTimeType rt; // response time (first dispatch - arrival)
+    int tenant; // tenant or user the process belongs to
 }ProcessType; 
 
-typedef int (*Comparer) (const void *a, const void *b);
-
-#endif				// PROCESS_H
\ No newline at end of file
+#endif				// PROCESS_H
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "progress.h"
+
+static double wall_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(ProgressType *p, double elapsed)
+{
+    const char *label = __atomic_load_n(&p->label, __ATOMIC_RELAXED);
+
+    fprintf(stderr, "[%7.1fs] %s: time %ld, %ld events, %ld processes done\n", elapsed,
+            label != NULL ? label : "-", __atomic_load_n(&p->now, __ATOMIC_RELAXED),
+            __atomic_load_n(&p->events, __ATOMIC_RELAXED),
+            __atomic_load_n(&p->done, __ATOMIC_RELAXED));
+}
+
+// Sleeps until the next report or the end of the budget, whichever is
+// first, until progress_end() or the budget runs out
+static void *watch(void *arg)
+{
+    ProgressType *p = (ProgressType *) arg;
+    double next = p->interval > 0 ? p->interval : p->budget;
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->quit) {
+        double wake_at = next;
+        struct timespec ts;
+
+        if (p->budget > 0 && p->budget < wake_at)
+            wake_at = p->budget;
+        wake_at += p->start;
+        ts.tv_sec = (time_t) wake_at;
+        ts.tv_nsec = (long) ((wake_at - ts.tv_sec) * 1e9);
+        pthread_cond_timedwait(&p->wake, &p->lock, &ts);
+        if (p->quit)
+            break;
+
+        double elapsed = wall_now() - p->start;
+        if (p->interval > 0 && elapsed >= next) {
+            report(p, elapsed);
+            while (next <= elapsed)
+                next += p->interval;
+        }
+        if (p->budget > 0 && elapsed >= p->budget) {
+            __atomic_store_n(&p->stop, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/**
+ * Starts the side thread, reporting every interval seconds and
+ * stopping the run after budget seconds; either may be 0 for none.
+ * The budget covers every run made until progress_end().
+ */
+void progress_start(ProgressType *p, double interval, double budget)
+{
+    pthread_condattr_t attr;
+
+    p->now = p->events = p->done = 0;
+    p->stop = 0;
+    p->label = NULL;
+    p->interval = interval;
+    p->budget = budget;
+    p->start = wall_now();
+    p->quit = false;
+    pthread_mutex_init(&p->lock, NULL);
+    // Deadlines are on the same clock as start
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_create(&p->tid, NULL, watch, p);
+}
+
+// Names the run about to start and resets the counters
+void progress_label(ProgressType *p, const char *label)
+{
+    __atomic_store_n(&p->now, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&p->events, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&p->done, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&p->label, label, __ATOMIC_RELAXED);
+}
+
+bool progress_stopped(const ProgressType *p)
+{
+    return __atomic_load_n(&p->stop, __ATOMIC_RELAXED) != 0;
+}
+
+void progress_end(ProgressType *p)
+{
+    pthread_mutex_lock(&p->lock);
+    p->quit = true;
+    pthread_cond_signal(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    pthread_join(p->tid, NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->wake);
+}
@@ -0,0 +1,42 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/**
+ * Progress reporting and a wall-clock budget for long runs. The engine
+ * publishes its simulated time, event count and completed processes
+ * every PROGRESS_STRIDE events with relaxed atomic stores, and checks
+ * the stop flag at the same point, so the hot loop pays a counter
+ * compare per event. A side thread wakes every interval seconds to
+ * print the counters to stderr and raises stop once the budget is
+ * spent. A stopped run leaves its metrics over the processes that
+ * completed.
+ */
+
+#define PROGRESS_STRIDE 1024
+
+typedef struct Progress {
+    // Written by the engine, read by the side thread
+    long now;			// simulated time
+    long events;
+    long done;			// completed processes
+    // Written by the side thread, read by the engine
+    int stop;
+    const char *label;		// name of the current run
+    double interval;		// seconds between reports, 0 for none
+    double budget;		// wall-clock seconds, 0 for none
+    double start;
+    pthread_t tid;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool quit;
+} ProgressType;
+
+void progress_start(ProgressType *, double, double);
+void progress_label(ProgressType *, const char *);
+bool progress_stopped(const ProgressType *);
+void progress_end(ProgressType *);
+
+#endif				// PROGRESS_H
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "queueing.h"
+#include "metrics.h"
+#include "process.h"
+#include "radix.h"
+
+/**
+ * One pass over plist: arrival span, service moments and, when the
+ * input is already arrival-sorted, the inter-arrival gap moments
+ */
+void queue_fit(const ProcessType plist[], int n, WorkloadFitType *w)
+{
+    double sum_bt = 0, sum_bt2 = 0, sum_gap = 0, sum_gap2 = 0;
+    SimTimeType min_art = plist[0].art, max_art = plist[0].art;
+    bool sorted = true;
+
+    for (int i = 0; i < n; i++) {
+        sum_bt += plist[i].bt;
+        sum_bt2 += (double) plist[i].bt * plist[i].bt;
+        if (plist[i].art < min_art)
+            min_art = plist[i].art;
+        if (plist[i].art > max_art)
+            max_art = plist[i].art;
+        if (i > 0) {
+            double gap = plist[i].art - plist[i - 1].art;
+            if (gap < 0)
+                sorted = false;
+            sum_gap += gap;
+            sum_gap2 += gap * gap;
+        }
+    }
+
+    memset(w, 0, sizeof(*w));
+    w->n = n;
+    w->mean_bt = sum_bt / n;
+    w->m2_bt = sum_bt2 / n;
+    w->cs2 = w->mean_bt > 0 ? w->m2_bt / (w->mean_bt * w->mean_bt) - 1 : 0;
+    w->ca2 = -1;
+    if (max_art > min_art) {
+        w->lambda = (double) (n - 1) / (max_art - min_art);
+        if (sorted) {
+            double mean_gap = sum_gap / (n - 1);
+            w->ca2 = (sum_gap2 / (n - 1)) / (mean_gap * mean_gap) - 1;
+        }
+    }
+    w->rho = w->lambda * w->mean_bt;
+}
+
+/**
+ * Mean SRPT response time for the empirical service distribution,
+ * T(x) = lambda*(E[S^2; S<=x] + x^2 P(S>x)) / (2 (1-rho(x))^2)
+ *        + integral_0^x dt / (1-rho(t))
+ * where rho(x) is the load brought by jobs no larger than x. One sweep
+ * over the sorted burst times evaluates T at every distinct size.
+ */
+static double srpt_mean_response(const ProcessType plist[], int n, double lambda)
+{
+    uint64_t *bt = (uint64_t *) malloc(n * sizeof(uint64_t));
+    double load = 0, m2 = 0, residence = 0, total = 0;
+    SimTimeType prev = 0;
+
+    for (int i = 0; i < n; i++)
+        bt[i] = RADIX_KEY(plist[i].bt);
+    radix_sort_column(bt, n, 0);
+
+    for (int i = 0; i < n;) {
+        SimTimeType x = RADIX_VALUE(bt[i]);
+        int count = 0;
+
+        // Below x only strictly smaller jobs add load
+        residence += (x - prev) / (1 - load);
+        while (i < n && RADIX_VALUE(bt[i]) == x) {
+            load += lambda * x / n;
+            m2 += (double) x * x / n;
+            count++;
+            i++;
+        }
+        double tail = (double) (n - i) / n;
+        double waiting = lambda * (m2 + (double) x * x * tail) / (2 * (1 - load) * (1 - load));
+        total += count * (waiting + residence);
+        prev = x;
+    }
+
+    free(bt);
+    return total / n;
+}
+
+void queue_model(const ProcessType plist[], int n, const WorkloadFitType *w, QueueModelType *q)
+{
+    memset(q, 0, sizeof(*q));
+    q->stable = w->lambda > 0 && w->rho < 1;
+    if (!q->stable)
+        return;
+
+    q->fcfs_wt = w->lambda * w->m2_bt / (2 * (1 - w->rho));
+    if (w->ca2 >= 0)
+        q->gg1_wt = (w->ca2 + w->cs2) / 2 * w->rho / (1 - w->rho) * w->mean_bt;
+    q->ps_tat = w->mean_bt / (1 - w->rho);
+    q->srpt_tat = srpt_mean_response(plist, n, w->lambda);
+}
+
+static void queue_print_row(const char *policy, const char *model, double model_wt,
+                            double mean_bt, const MetricsType *sim)
+{
+    double model_tat = model_wt + mean_bt;
+
+    printf("\t%s\t%s\t%.2f\t\t%.2f", policy, model, model_wt, model_tat);
+    if (sim != NULL) {
+        double sim_tat = (double) sim->total_tat / sim->n;
+        printf("\t\t%.2f\t\t%.2f\t\t%+.1f%%", (double) sim->total_wt / sim->n, sim_tat,
+               sim_tat > 0 ? 100 * (model_tat - sim_tat) / sim_tat : 0.0);
+    }
+    printf("\n");
+}
+
+/**
+ * Prints the fitted workload and the model estimates, next to the
+ * simulated averages when the simulation was run (metrics not NULL)
+ */
+void queue_print(const WorkloadFitType *w, const QueueModelType *q,
+                 const MetricsType *fcfs, const MetricsType *rr, const MetricsType *sjf)
+{
+    printf("\n*********\nQueueing model\n");
+    printf("lambda = %.4f, E[S] = %.2f, Cs^2 = %.2f, rho = %.3f", w->lambda, w->mean_bt, w->cs2, w->rho);
+    if (w->ca2 >= 0)
+        printf(", Ca^2 = %.2f", w->ca2);
+    printf("\n");
+
+    if (!q->stable) {
+        printf("Model not applicable: %s\n",
+               w->lambda > 0 ? "rho >= 1, the queue is unstable" : "all processes arrive at once");
+        return;
+    }
+
+    printf("\tPolicy\tModel\t\tWaiting time\tTurn around time");
+    if (fcfs != NULL)
+        printf("\tSim waiting\tSim turn around\tError");
+    printf("\n");
+    queue_print_row("FCFS", "M/G/1 P-K", q->fcfs_wt, w->mean_bt, fcfs);
+    if (w->ca2 >= 0)
+        queue_print_row("FCFS", "G/G/1 Kingman", q->gg1_wt, w->mean_bt, fcfs);
+    queue_print_row("RR", "M/G/1-PS", q->ps_tat - w->mean_bt, w->mean_bt, rr);
+    queue_print_row("SJF", "M/G/1-SRPT", q->srpt_tat - w->mean_bt, w->mean_bt, sjf);
+}
@@ -0,0 +1,38 @@
+#ifndef QUEUEING_H
+#define QUEUEING_H
+
+#include <stdbool.h>
+#include "process.h"
+#include "metrics.h"
+
+/**
+ * Analytical queueing estimates used as a fast approximate mode.
+ * queue_fit() fits arrival rate and service moments from the art/bt
+ * columns in one pass; queue_model() evaluates closed-form M/G/1
+ * results for the policies the simulator implements.
+ */
+
+typedef struct WorkloadFit {
+    long n;
+    double lambda;		// arrival rate
+    double mean_bt;		// E[S]
+    double m2_bt;		// E[S^2]
+    double cs2;			// squared coefficient of variation of service
+    double ca2;			// same for inter-arrival gaps, -1 if input is unsorted
+    double rho;			// utilisation lambda * E[S]
+} WorkloadFitType;
+
+typedef struct QueueModel {
+    bool stable;		// rho < 1 and a positive arrival span
+    double fcfs_wt;		// M/G/1 Pollaczek-Khinchine
+    double gg1_wt;		// G/G/1 Kingman approximation
+    double ps_tat;		// M/G/1-PS, the quantum -> 0 limit of RR
+    double srpt_tat;	// M/G/1-SRPT (Schrage-Miller) on the empirical bt distribution
+} QueueModelType;
+
+void queue_fit(const ProcessType[], int, WorkloadFitType *);
+void queue_model(const ProcessType[], int, const WorkloadFitType *, QueueModelType *);
+void queue_print(const WorkloadFitType *, const QueueModelType *,
+                 const MetricsType *, const MetricsType *, const MetricsType *);
+
+#endif				// QUEUEING_H
@@ -0,0 +1,147 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mem.h"
+#include "radix.h"
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX_BUCKETS - 1)
+
+typedef struct RadixChunk {
+    pthread_t tid;
+    const uint64_t *keys;
+    const int *idx;			// NULL when sorting a bare column
+    uint64_t *out_keys;
+    int *out_idx;
+    long lo, hi;
+    int shift;
+    long count[RADIX_BUCKETS];	// digit histogram, then scatter offsets
+} RadixChunkType;
+
+static void *chunk_count(void *arg)
+{
+    RadixChunkType *c = (RadixChunkType *) arg;
+
+    memset(c->count, 0, sizeof(c->count));
+    for (long i = c->lo; i < c->hi; i++)
+        c->count[(c->keys[i] >> c->shift) & RADIX_MASK]++;
+    return NULL;
+}
+
+static void *chunk_scatter(void *arg)
+{
+    RadixChunkType *c = (RadixChunkType *) arg;
+
+    for (long i = c->lo; i < c->hi; i++) {
+        long at = c->count[(c->keys[i] >> c->shift) & RADIX_MASK]++;
+        c->out_keys[at] = c->keys[i];
+        if (c->idx != NULL)
+            c->out_idx[at] = c->idx[i];
+    }
+    return NULL;
+}
+
+// Runs fn over every chunk, chunk 0 on the calling thread
+static void run_chunks(RadixChunkType chunk[], int t, void *(*fn)(void *))
+{
+    for (int c = 1; c < t; c++)
+        pthread_create(&chunk[c].tid, NULL, fn, &chunk[c]);
+    fn(&chunk[0]);
+    for (int c = 1; c < t; c++)
+        pthread_join(chunk[c].tid, NULL);
+}
+
+static int radix_threads(int n, int threads)
+{
+    if (threads <= 0)
+        threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > RADIX_MAX_THREADS)
+        threads = RADIX_MAX_THREADS;
+    if (threads < 1 || n < RADIX_PARALLEL_MIN)
+        return 1;
+    // Keep chunks large enough to pay for the thread start
+    if (threads > n / (RADIX_PARALLEL_MIN / 4))
+        threads = n / (RADIX_PARALLEL_MIN / 4);
+    return threads;
+}
+
+// Sorts keys, carrying idx along when it is not NULL
+static void radix_sort_pairs(uint64_t *keys, int *idx, int n, int threads)
+{
+    RadixChunkType chunk[RADIX_MAX_THREADS];
+    uint64_t *tmp_keys, *src_keys = keys, *dst_keys;
+    int *tmp_idx = NULL, *src_idx = idx, *dst_idx;
+    int t = radix_threads(n, threads);
+
+    if (n < 2)
+        return;
+    tmp_keys = (uint64_t *) mem_alloc(n * sizeof(uint64_t));
+    if (idx != NULL)
+        tmp_idx = (int *) mem_alloc(n * sizeof(int));
+    dst_keys = tmp_keys;
+    dst_idx = tmp_idx;
+
+    // Bits on which some key differs from the first
+    uint64_t differ = 0;
+    for (int i = 1; i < n; i++)
+        differ |= keys[i] ^ keys[0];
+
+    for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+        if (((differ >> shift) & RADIX_MASK) == 0)
+            continue;
+        for (int c = 0; c < t; c++) {
+            chunk[c].keys = src_keys;
+            chunk[c].idx = src_idx;
+            chunk[c].out_keys = dst_keys;
+            chunk[c].out_idx = dst_idx;
+            chunk[c].lo = (long) n * c / t;
+            chunk[c].hi = (long) n * (c + 1) / t;
+            chunk[c].shift = shift;
+        }
+        run_chunks(chunk, t, chunk_count);
+
+        // Digit-major, chunk-minor offsets keep equal keys in order
+        long at = 0;
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            for (int c = 0; c < t; c++) {
+                long cnt = chunk[c].count[d];
+                chunk[c].count[d] = at;
+                at += cnt;
+            }
+        }
+        run_chunks(chunk, t, chunk_scatter);
+
+        uint64_t *swap_keys = src_keys;
+        int *swap_idx = src_idx;
+        src_keys = dst_keys;
+        src_idx = dst_idx;
+        dst_keys = swap_keys;
+        dst_idx = swap_idx;
+    }
+
+    if (src_keys != keys) {
+        memcpy(keys, src_keys, n * sizeof(uint64_t));
+        if (idx != NULL)
+            memcpy(idx, src_idx, n * sizeof(int));
+    }
+    mem_free(tmp_keys);
+    mem_free(tmp_idx);
+}
+
+void radix_sort_index(const uint64_t keys[], int order[], int n, int threads)
+{
+    uint64_t *gathered = (uint64_t *) mem_alloc(n * sizeof(uint64_t));
+
+    for (int i = 0; i < n; i++)
+        gathered[i] = keys[order[i]];
+    radix_sort_pairs(gathered, order, n, threads);
+    mem_free(gathered);
+}
+
+void radix_sort_column(uint64_t keys[], int n, int threads)
+{
+    radix_sort_pairs(keys, NULL, n, threads);
+}
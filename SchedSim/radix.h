@@ -0,0 +1,32 @@
+#ifndef RADIX_H
+#define RADIX_H
+
+#include <stdint.h>
+
+/**
+ * Stable LSD radix sort over 64-bit unsigned keys, 8 bits per pass.
+ * Digits on which all keys agree are found in one scan and skipped, so
+ * small keys such as priorities cost one or two passes and times cost
+ * only as many as their range needs. From RADIX_PARALLEL_MIN
+ * keys on, each pass is split over up to threads worker threads (0
+ * means one per online CPU); chunks scatter in chunk order, which keeps
+ * the sort stable.
+ *
+ * radix_sort_index() reorders an index permutation by keys[order[i]],
+ * keys being one column of the process table; sorting the same order
+ * by a secondary then a primary key gives a multi-key sort.
+ * radix_sort_column() sorts a key column in place.
+ */
+
+#define RADIX_PARALLEL_MIN (1 << 16)
+#define RADIX_MAX_THREADS 16
+
+// Order-preserving maps between signed 64-bit values and sort keys
+#define RADIX_KEY(v) ((uint64_t) (int64_t) (v) ^ 0x8000000000000000ull)
+#define RADIX_KEY_DESC(v) (~RADIX_KEY(v))
+#define RADIX_VALUE(k) ((int64_t) ((k) ^ 0x8000000000000000ull))
+
+void radix_sort_index(const uint64_t *, int *, int, int);
+void radix_sort_column(uint64_t *, int, int);
+
+#endif				// RADIX_H
@@ -0,0 +1,36 @@
+#include <stdio.h>
+
+#include "metrics.h"
+#include "process.h"
+#include "report.h"
+
+// Function to print metrics
+// Rows follow order (input order if NULL); totals come from the
+// metrics gathered while scheduling
+void printMetrics(ProcessType plist[], const int order[], int n, const MetricsType *m) {
+    double awt, att;
+    
+    printf("\tProcesses\tBurst time\tWaiting time\tTurn around time\n");
+    
+    for (int i = 0; i < n; i++) {
+        const ProcessType *p = &plist[order ? order[i] : i];
+        printf("\t%d\t\t%" PRIdTIME "\t\t%" PRIdTIME "\t\t%" PRIdTIME "\n", p->pid, p->bt, p->wt, p->tat);
+    }
+    
+    // Nanosecond totals need more digits than a float carries
+    awt = ((double)m->total_wt / n);
+    att = ((double)m->total_tat / n);
+    
+    printf("\nAverage waiting time = %.2f", awt);
+    printf("\nAverage turn around time = %.2f\n", att);
+    metrics_print(m);
+}
+
+// Function to print the averages of a run that has no per-process table
+void printSummary(const char *title, const MetricsType *m) {
+    printf("\n*********\n%s\n", title);
+    printf("Processes = %ld\n", m->n);
+    printf("Average waiting time = %.2f", m->n ? (double)m->total_wt / m->n : 0.0);
+    printf("\nAverage turn around time = %.2f\n", m->n ? (double)m->total_tat / m->n : 0.0);
+    metrics_print(m);
+}
@@ -0,0 +1,23 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "metrics.h"
+#include "process.h"
+
+/**
+ * Text reports on stdout: the per-process table of the classic
+ * schedulers, and the summary of runs that have no such table
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void printMetrics(ProcessType[], const int[], int, const MetricsType *);
+void printSummary(const char *, const MetricsType *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				// REPORT_H
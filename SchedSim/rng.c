@@ -0,0 +1,74 @@
+#include <math.h>
+#include <stdint.h>
+
+#include "rng.h"
+
+static uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+// splitmix64 expands the seed so nearby seeds give unrelated states
+void rng_seed(RngType *r, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        r->s[i] = z ^ (z >> 31);
+    }
+}
+
+uint64_t rng_next(RngType *r)
+{
+    uint64_t *s = r->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+void rng_jump(RngType *r)
+{
+    static const uint64_t jump[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    uint64_t s[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (jump[i] & (1ULL << b)) {
+                for (int k = 0; k < 4; k++)
+                    s[k] ^= r->s[k];
+            }
+            rng_next(r);
+        }
+    }
+    for (int k = 0; k < 4; k++)
+        r->s[k] = s[k];
+}
+
+// Uniform in (0, 1), never exactly 0 so it is safe under log()
+double rng_uniform(RngType *r)
+{
+    return ((rng_next(r) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double rng_exp(RngType *r, double mean)
+{
+    return -mean * log(rng_uniform(r));
+}
+
+// Standard normal by Box-Muller; the second value is discarded
+double rng_normal(RngType *r)
+{
+    double u1 = rng_uniform(r), u2 = rng_uniform(r);
+    return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
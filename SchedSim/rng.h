@@ -0,0 +1,23 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * xoshiro256** generator. rng_jump() advances a state by 2^128 draws,
+ * so seeding once and jumping k times gives k non-overlapping streams
+ * for parallel workers.
+ */
+
+typedef struct Rng {
+    uint64_t s[4];
+} RngType;
+
+void rng_seed(RngType *, uint64_t);
+void rng_jump(RngType *);
+uint64_t rng_next(RngType *);
+double rng_uniform(RngType *);
+double rng_exp(RngType *, double);
+double rng_normal(RngType *);
+
+#endif				// RNG_H
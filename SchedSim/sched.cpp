@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <vector>
+
+#include "sched.hpp"
+
+extern "C" {
+#include "sched.h"
+#include "util.h"
+}
+
+/**
+ * C entry points of the classic schedulers, backed by the templated
+ * engine in sched.hpp. Linked in place of the C versions in classic.c.
+ */
+
+void findavgTimeFCFS(ProcessType plist[], int n, MetricsType *m)
+{
+    sched::FifoQueue ready(n);
+    sched::NullSink sink;
+
+    sched::run<sched::Fcfs>(plist, n, nullptr, 0, ready, sink);
+    sched::gather(plist, n, m);
+    std::printf("\n*********\nFCFS\n");
+}
+
+// order receives the dispatch order, highest priority first with ties in input order
+void findavgTimePriority(ProcessType plist[], int order[], int n, MetricsType *m)
+{
+    sched::RankQueue ready(n);
+    sched::NullSink done;
+    sched::OrderSink<sched::NullSink> sink(order, done);
+
+    sched::run<sched::Priority>(plist, n, nullptr, 0, ready, sink);
+    sched::gather(plist, n, m);
+    std::printf("\n*********\nPriority\n");
+}
+
+void findavgTimeSJF(ProcessType plist[], int n, MetricsType *m)
+{
+    std::vector<int> arrival(n);
+    sched::HeapQueue ready(n);
+    sched::NullSink sink;
+
+    sort_by_arrival(plist, n, arrival.data());
+    sched::run<sched::Sjf>(plist, n, arrival.data(), 0, ready, sink);
+    sched::gather(plist, n, m);
+    std::printf("\n*********\nSJF\n");
+}
+
+void findavgTimeRR(ProcessType plist[], int n, SimTimeType quantum, MetricsType *m)
+{
+    std::vector<int> arrival(n);
+    sched::FifoQueue ready(n);
+    sched::NullSink sink;
+
+    sort_by_arrival(plist, n, arrival.data());
+    sched::run<sched::RoundRobin>(plist, n, arrival.data(), quantum, ready, sink);
+    sched::gather(plist, n, m);
+    std::printf("\n*********\nRR Quantum = %" PRIdTIME "\n", quantum);
+}
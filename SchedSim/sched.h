@@ -0,0 +1,33 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "metrics.h"
+#include "process.h"
+
+/**
+ * The classic whole-list schedulers. Each fills wt, tat and rt of every
+ * process in plist, gathers m and prints the policy title. They are
+ * implemented in C in classic.c, or by the templated C++ engine in
+ * sched.cpp, which schedsim-cxx links instead.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void findavgTimeFCFS(ProcessType[], int, MetricsType *);
+void findavgTimePriority(ProcessType[], int[], int, MetricsType *);
+void findavgTimeSJF(ProcessType[], int, MetricsType *);
+void findavgTimeRR(ProcessType[], int, SimTimeType, MetricsType *);
+
+// Building blocks of the C versions, which the benchmarks time alone
+void findWaitingTimeFCFS(ProcessType[], const int[], int);
+void findWaitingTimeSJF(ProcessType[], int);
+void findWaitingTimeRR(ProcessType[], int, SimTimeType);
+void findTurnAroundTime(ProcessType[], int, MetricsType *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				// SCHED_H
@@ -0,0 +1,244 @@
+#ifndef SCHED_HPP
+#define SCHED_HPP
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "metrics.h"
+#include "process.h"
+#include "radix.h"
+}
+
+/**
+ * Header-only scheduling engine over a whole process list. The policy,
+ * the ready queue and the metrics sink are template parameters, so each
+ * combination gets its own dispatch loop with the key, slice and sink
+ * calls inlined; nothing on the hot path goes through a function
+ * pointer or a switch.
+ *
+ * A Policy provides
+ *   static constexpr bool offline       every process is queued up front
+ *                                       and waits for its arrival at dispatch
+ *   static constexpr bool preemptive    the running process yields to arrivals
+ *   static long key(p, rem)             ready queue key, smaller runs first
+ *   static long slice(rem, quantum)     time to run before yielding
+ * A Queue provides empty(), push(key, idx) and pop(), equal keys going
+ * to the lower index. A Sink provides finish(p, idx), called once per
+ * process as it completes.
+ *
+ * Results are those of the findWaitingTime* functions in classic.c.
+ */
+
+namespace sched {
+
+// Classic FCFS: input order, a process waits for the previous one
+struct Fcfs {
+    static constexpr bool offline = true;
+    static constexpr bool preemptive = false;
+    static long key(const ProcessType &, long) { return 0; }
+    static long slice(long rem, SimTimeType) { return rem; }
+};
+
+// Non-preemptive, highest priority first regardless of arrival
+struct Priority {
+    static constexpr bool offline = true;
+    static constexpr bool preemptive = false;
+    static long key(const ProcessType &p, long) { return -(long) p.pri; }
+    static long slice(long rem, SimTimeType) { return rem; }
+};
+
+// Shortest remaining time first, preempting on arrival
+struct Sjf {
+    static constexpr bool offline = false;
+    static constexpr bool preemptive = true;
+    static long key(const ProcessType &, long rem) { return rem; }
+    static long slice(long rem, SimTimeType) { return rem; }
+};
+
+struct RoundRobin {
+    static constexpr bool offline = false;
+    static constexpr bool preemptive = false;
+    static long key(const ProcessType &, long) { return 0; }
+    static long slice(long rem, SimTimeType quantum) { return rem > quantum ? quantum : rem; }
+};
+
+// FIFO ring; every process is queued at most once, so n slots suffice
+class FifoQueue {
+public:
+    explicit FifoQueue(int n) : ring_(n > 0 ? n : 1), head_(0), tail_(0), size_(0) {}
+    bool empty() const { return size_ == 0; }
+    void push(long, int idx) {
+        ring_[tail_] = idx;
+        if (++tail_ == (int) ring_.size())
+            tail_ = 0;
+        size_++;
+    }
+    int pop() {
+        int idx = ring_[head_];
+        if (++head_ == (int) ring_.size())
+            head_ = 0;
+        size_--;
+        return idx;
+    }
+
+private:
+    std::vector<int> ring_;
+    int head_, tail_, size_;
+};
+
+// Min-heap of (key, idx); pairs compare on idx after key
+class HeapQueue {
+public:
+    explicit HeapQueue(int n) {
+        std::vector<Node> nodes;
+        nodes.reserve(n);
+        heap_ = Heap(std::greater<Node>(), std::move(nodes));
+    }
+    bool empty() const { return heap_.empty(); }
+    void push(long key, int idx) { heap_.emplace(key, idx); }
+    int pop() {
+        int idx = heap_.top().second;
+        heap_.pop();
+        return idx;
+    }
+
+private:
+    typedef std::pair<long, int> Node;
+    typedef std::priority_queue<Node, std::vector<Node>, std::greater<Node>> Heap;
+    Heap heap_;
+};
+
+/**
+ * For offline policies, whose keys are all pushed before the first pop:
+ * one stable radix sort on the first pop instead of a heap operation
+ * per process. Pushes must come in index order.
+ */
+class RankQueue {
+public:
+    explicit RankQueue(int n) : next_(0), sorted_(false) {
+        keys_.reserve(n);
+        order_.reserve(n);
+    }
+    bool empty() const { return next_ == order_.size(); }
+    void push(long key, int idx) {
+        keys_.push_back(RADIX_KEY(key));
+        order_.push_back(idx);
+    }
+    int pop() {
+        if (!sorted_) {
+            radix_sort_index(keys_.data(), order_.data(), (int) order_.size(), 0);
+            sorted_ = true;
+        }
+        return order_[next_++];
+    }
+
+private:
+    std::vector<uint64_t> keys_;
+    std::vector<int> order_;
+    size_t next_;
+    bool sorted_;
+};
+
+class NullSink {
+public:
+    void finish(const ProcessType &, int) {}
+};
+
+/**
+ * Gathers m over plist after a run. Processes are added in input order
+ * rather than as they finish, like findTurnAroundTime() does, so the
+ * floating-point sums and averages match the C schedulers to the last
+ * digit.
+ */
+inline void gather(const ProcessType plist[], int n, MetricsType *m)
+{
+    metrics_init(m);
+    for (int i = 0; i < n; i++)
+        metrics_add(m, &plist[i]);
+}
+
+// Records completion order, which for non-preemptive policies is the
+// dispatch order, then passes each process on
+template <class Next>
+class OrderSink {
+public:
+    OrderSink(int order[], Next &next) : order_(order), k_(0), next_(next) {}
+    void finish(const ProcessType &p, int idx) {
+        order_[k_++] = idx;
+        next_.finish(p, idx);
+    }
+
+private:
+    int *order_;
+    int k_;
+    Next &next_;
+};
+
+/**
+ * Runs plist to completion and returns the time the last process
+ * finished. arrival lists the indices of plist by arrival time, ties in
+ * input order; offline policies do not use it.
+ */
+template <class Policy, class Queue, class Sink>
+long run(ProcessType plist[], int n, const int arrival[], SimTimeType quantum, Queue &ready, Sink &sink)
+{
+    std::vector<long> rem(n);
+    long t = 0;
+    int next = 0, done = 0, requeue = -1;
+
+    for (int i = 0; i < n; i++)
+        rem[i] = plist[i].bt;
+    if (Policy::offline) {
+        for (int i = 0; i < n; i++)
+            ready.push(Policy::key(plist[i], rem[i]), i);
+        next = n;
+    }
+
+    while (done < n) {
+        // Idle CPU: jump to the next arrival
+        if (requeue < 0 && ready.empty() && next < n && plist[arrival[next]].art > t)
+            t = plist[arrival[next]].art;
+
+        while (next < n && plist[arrival[next]].art <= t) {
+            int i = arrival[next++];
+            ready.push(Policy::key(plist[i], rem[i]), i);
+        }
+        // Arrivals during the last slice queue ahead of the preempted process
+        if (requeue >= 0) {
+            ready.push(Policy::key(plist[requeue], rem[requeue]), requeue);
+            requeue = -1;
+        }
+
+        int curr = ready.pop();
+        ProcessType &p = plist[curr];
+        if (Policy::offline && p.art > t)
+            t = p.art;
+        // First dispatch of this process
+        if (rem[curr] == p.bt)
+            p.rt = t - p.art;
+
+        long slice = Policy::slice(rem[curr], quantum);
+        if (Policy::preemptive && next < n && plist[arrival[next]].art < t + slice)
+            slice = plist[arrival[next]].art - t;
+
+        t += slice;
+        rem[curr] -= slice;
+        if (rem[curr] == 0) {
+            p.tat = t - p.art;
+            p.wt = p.tat - p.bt;
+            sink.finish(p, curr);
+            done++;
+        } else {
+            requeue = curr;
+        }
+    }
+    return t;
+}
+
+}				// namespace sched
+
+#endif				// SCHED_HPP
@@ -3,281 +3,533 @@
 #include <string.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <unistd.h>
 #include "process.h"
 #include "util.h"
+#include "metrics.h"
+#include "compare.h"
+#include "queueing.h"
+#include "heap.h"
+#include "bounds.h"
+#include "engine.h"
+#include "fork.h"
+#include "source.h"
+#include "workload.h"
+#include "extsort.h"
+#include "mem.h"
+#include "merge.h"
+#include "noise.h"
+#include "progress.h"
+#include "radix.h"
+#include "report.h"
+#include "sched.h"
 
-// Comparator function for Priority Scheduling (highest priority first)
-int my_comparer(const void *this, const void *that) {
-    const ProcessType *p1 = (const ProcessType *)this;
-    const ProcessType *p2 = (const ProcessType *)that;
-    return p2->pri - p1->pri;
+// Function to set up the engine for one policy's run from the shared
+// options, naming the run for the progress reports
+EngineType policyEngine(const EngineType *opts, int p, EngineWorkType *work) {
+    EngineType e = *opts;
+    
+    e.policy = (PolicyType)p;
+    e.work = work;
+    if (e.progress != NULL)
+        progress_label(e.progress, engine_policy_name(e.policy));
+    return e;
 }
 
-// Comparator function for SJF (shortest burst time first)
-int sjf_comparer(const void *this, const void *that) {
-    const ProcessType *p1 = (const ProcessType *)this;
-    const ProcessType *p2 = (const ProcessType *)that;
-    return p1->bt - p2->bt;
+// Function to check whether the time budget cut the last run short. Its
+// summary then covers only the completed processes, and the remaining
+// policies are skipped.
+bool budgetSpent(const EngineType *e, const MetricsType *m) {
+    if (e->progress == NULL || !progress_stopped(e->progress))
+        return false;
+    printf("\nTime budget of %g s reached during %s: %ld processes completed, "
+           "remaining policies skipped\n", e->progress->budget, engine_policy_name(e->policy), m->n);
+    return true;
 }
 
-// Function to find waiting time for all processes (FCFS with arrival time)
-void findWaitingTimeFCFS(ProcessType plist[], int n) {
-    int service_time[n];
-    
-    service_time[0] = plist[0].art;
-    plist[0].wt = 0;
-    
-    for (int i = 1; i < n; i++) {
-        service_time[i] = service_time[i-1] + plist[i-1].bt;
-        
-        if (service_time[i] < plist[i].art) {
-            service_time[i] = plist[i].art;
-        }
-        
-        plist[i].wt = service_time[i] - plist[i].art;
-        
-        if (plist[i].wt < 0) {
-            plist[i].wt = 0;
-        }
-    }
+// Function to start the progress thread if a report interval or time
+// budget was asked for; the budget counts from here, after loading
+ProgressType *startProgress(ProgressType *progress, double interval, double budget) {
+    if (interval <= 0 && budget <= 0)
+        return NULL;
+    progress_start(progress, interval, budget);
+    return progress;
 }
 
-// Function to find turnaround time for all processes
-void findTurnAroundTime(ProcessType plist[], int n) {
-    for (int i = 0; i < n; i++) {
-        plist[i].tat = plist[i].bt + plist[i].wt;
-    }
+// Function to print the CPU time the last run lost to noise and to
+// the scheduler's own decisions, and what admission control turned away
+void printOverheads(const EngineType *e, const MetricsType *m) {
+    if (e->noise != NULL)
+        printf("Noise events = %ld, CPU time lost = %" PRIdTIME "\n", e->noise->events, e->noise->stolen);
+    if (m->decisions > 0)
+        printf("Decisions = %ld, mean ready queue = %.2f, scheduler overhead = %ld\n", m->decisions,
+               (double)m->decision_queue / m->decisions, m->overhead);
+    if (e->admission != NULL)
+        printf("Accepted = %ld, rejected = %ld (%ld on arrival, %ld dropped while waiting)\n",
+               m->admitted - m->dropped, m->rejected + m->dropped, m->rejected, m->dropped);
 }
 
-// IMPROVED: Function to find waiting time for SJF (SRTF - Preemptive)
-// Now skips idle time instead of incrementing by 1
-void findWaitingTimeSJF(ProcessType plist[], int n) {
-    int *rem_bt = (int *)malloc(n * sizeof(int));
-    int *completed = (int *)calloc(n, sizeof(int)); // Track completed processes
-    int complete = 0, t = 0;
-    
-    // Copy burst times to remaining burst time array
-    for (int i = 0; i < n; i++) {
-        rem_bt[i] = plist[i].bt;
-    }
+// Function to run every policy through the online engine on plist
+void runEngine(ProcessType plist[], int n, const EngineType *opts, FILE *csv_file) {
+    int *order = (int *)mem_alloc(n * sizeof(int));
+    MetricsType *m = (MetricsType *)malloc(sizeof(MetricsType));
+    EngineWorkType work;
     
-    while (complete != n) {
-        int shortest = -1;
-        int minm = INT_MAX;
-        
-        // Find process with minimum remaining time among arrived processes
-        for (int j = 0; j < n; j++) {
-            if (plist[j].art <= t && rem_bt[j] > 0 && rem_bt[j] < minm) {
-                minm = rem_bt[j];
-                shortest = j;
-            }
-        }
+    sort_by_arrival(plist, n, order);
+    engine_work_init(&work);
+    for (int p = POLICY_FCFS; p <= POLICY_RR; p++) {
+        EngineType e = policyEngine(opts, p, &work);
+        SourceType src;
+        ArraySourceType array;
         
-        // IMPROVEMENT: If no process is ready, jump to next arrival time
-        if (shortest == -1) {
-            int next_arrival = INT_MAX;
-            for (int j = 0; j < n; j++) {
-                if (rem_bt[j] > 0 && plist[j].art < next_arrival) {
-                    next_arrival = plist[j].art;
-                }
-            }
-            t = next_arrival;
-            continue;
-        }
+        array_source_init(&src, &array, plist, order, n);
+        engine_run(&e, &src, m);
+        printSummary(engine_policy_name(e.policy), m);
+        printOverheads(&e, m);
+        if (csv_file != NULL)
+            metrics_csv(csv_file, engine_policy_name(e.policy), m);
+        if (budgetSpent(&e, m))
+            break;
+    }
+    
+    engine_work_free(&work);
+    mem_free(order);
+    free(m);
+}
+
+// Function to run every policy on a closed-loop workload whose service
+// times and priorities are resampled from plist
+void runClosedLoop(ProcessType plist[], int n, const EngineType *opts, int users,
+                   double think, long jobs, unsigned long long seed, FILE *csv_file) {
+    WorkloadModelType model;
+    MetricsType *m = (MetricsType *)malloc(sizeof(MetricsType));
+    EngineWorkType work;
+    
+    workload_fit(&model, plist, n, DIST_EMPIRICAL, DIST_EMPIRICAL);
+    engine_work_init(&work);
+    for (int p = POLICY_FCFS; p <= POLICY_RR; p++) {
+        EngineType e = policyEngine(opts, p, &work);
+        SourceType src;
+        ClosedLoopType closed;
         
-        // Execute for 1 time unit
-        rem_bt[shortest]--;
-        t++;
+        // Same seed for every policy so they see the same demand
+        closed_loop_init(&src, &closed, users, think, jobs, &model, seed);
+        long end = engine_run(&e, &src, m);
+        closed_loop_free(&closed);
         
-        // If process is completely executed
-        if (rem_bt[shortest] == 0) {
-            complete++;
-            int finish_time = t;
-            
-            // Waiting time = finish time - burst time - arrival time
-            plist[shortest].wt = finish_time - plist[shortest].bt - plist[shortest].art;
-            
-            if (plist[shortest].wt < 0)
-                plist[shortest].wt = 0;
+        printSummary(engine_policy_name(e.policy), m);
+        printOverheads(&e, m);
+        if (end > 0) {
+            double x = (double)m->n / end;
+            // Interactive response time law: R = N / X - Z
+            printf("Throughput = %.4f, N/X - Z = %.2f\n", x, users / x - think);
         }
+        if (csv_file != NULL)
+            metrics_csv(csv_file, engine_policy_name(e.policy), m);
+        if (budgetSpent(&e, m))
+            break;
     }
     
-    free(rem_bt);
-    free(completed);
+    engine_work_free(&work);
+    workload_free(&model);
+    free(m);
 }
 
-// IMPROVED: Function to find waiting time for Round Robin
-// Now properly handles arrival times
-void findWaitingTimeRR(ProcessType plist[], int n, int quantum) {
-    int *rem_bt = (int *)malloc(n * sizeof(int));
-    int *finish_time = (int *)malloc(n * sizeof(int));
-    int *in_queue = (int *)calloc(n, sizeof(int));  // Track if process is in ready queue
-    int *queue = (int *)malloc(n * sizeof(int));    // Ready queue (circular)
-    int front = 0, rear = 0, queue_size = 0;
-    
-    // Copy burst times
-    for (int i = 0; i < n; i++) {
-        rem_bt[i] = plist[i].bt;
-        finish_time[i] = 0;
-    }
+// Function to run every policy on a trace streamed through the
+// external sort, for unsorted traces that do not fit in memory
+int runExternalSort(FILE *input_file, long run_records, int threads, const EngineType *opts,
+                    FILE *csv_file) {
+    ExtSortType sorter;
+    MetricsType *m = (MetricsType *)malloc(sizeof(MetricsType));
+    EngineWorkType work;
     
-    // Sort indices by arrival time for initial queue loading
-    int *sorted_idx = (int *)malloc(n * sizeof(int));
-    for (int i = 0; i < n; i++) sorted_idx[i] = i;
-    
-    // Simple bubble sort by arrival time
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (plist[sorted_idx[j]].art > plist[sorted_idx[j+1]].art) {
-                int temp = sorted_idx[j];
-                sorted_idx[j] = sorted_idx[j+1];
-                sorted_idx[j+1] = temp;
-            }
-        }
+    if (extsort_runs(&sorter, input_file, run_records, threads) != 0) {
+        printf("Error: Could not create temporary run files\n");
+        extsort_free(&sorter);
+        free(m);
+        return 1;
     }
+    printf("Sorted %ld processes into %d runs\n", sorter.total, sorter.nruns);
     
-    int t = 0;
-    int completed = 0;
-    int next_arrival_idx = 0;  // Index into sorted_idx for next process to arrive
-    
-    // Add all processes that arrive at time 0
-    while (next_arrival_idx < n && plist[sorted_idx[next_arrival_idx]].art <= t) {
-        int idx = sorted_idx[next_arrival_idx];
-        queue[rear] = idx;
-        rear = (rear + 1) % n;
-        queue_size++;
-        in_queue[idx] = 1;
-        next_arrival_idx++;
+    engine_work_init(&work);
+    for (int p = POLICY_FCFS; p <= POLICY_RR; p++) {
+        EngineType e = policyEngine(opts, p, &work);
+        SourceType src;
+        
+        extsort_source(&src, &sorter);
+        engine_run(&e, &src, m);
+        printSummary(engine_policy_name(e.policy), m);
+        printOverheads(&e, m);
+        if (csv_file != NULL)
+            metrics_csv(csv_file, engine_policy_name(e.policy), m);
+        if (budgetSpent(&e, m))
+            break;
     }
     
-    while (completed < n) {
-        // If queue is empty, jump to next arrival
-        if (queue_size == 0) {
-            if (next_arrival_idx < n) {
-                t = plist[sorted_idx[next_arrival_idx]].art;
-                // Add all processes arriving at this time
-                while (next_arrival_idx < n && plist[sorted_idx[next_arrival_idx]].art <= t) {
-                    int idx = sorted_idx[next_arrival_idx];
-                    queue[rear] = idx;
-                    rear = (rear + 1) % n;
-                    queue_size++;
-                    in_queue[idx] = 1;
-                    next_arrival_idx++;
-                }
-            }
-            continue;
+    engine_work_free(&work);
+    extsort_free(&sorter);
+    free(m);
+    return 0;
+}
+
+// Function to run every policy on several arrival-sorted traces merged
+// on the fly, each file becoming its own tenant
+int runMerged(char *files[], int k, const EngineType *opts, FILE *csv_file) {
+    FILE **inputs = (FILE **)calloc(k, sizeof(FILE *));
+    TraceReaderType *readers = (TraceReaderType *)malloc(k * sizeof(TraceReaderType));
+    MetricsType *m = (MetricsType *)malloc(sizeof(MetricsType));
+    EngineWorkType work;
+    int status = 0;
+    
+    for (int i = 0; i < k && status == 0; i++) {
+        inputs[i] = fopen(files[i], "r");
+        if (inputs[i] == NULL) {
+            printf("Error: Could not open file %s\n", files[i]);
+            status = 1;
         }
+    }
+    
+    engine_work_init(&work);
+    for (int p = POLICY_FCFS; p <= POLICY_RR && status == 0; p++) {
+        EngineType e = policyEngine(opts, p, &work);
+        SourceType src;
+        MergeType merge;
         
-        // Get next process from queue
-        int curr = queue[front];
-        front = (front + 1) % n;
-        queue_size--;
-        
-        // Execute for quantum or remaining time, whichever is smaller
-        int exec_time = (rem_bt[curr] > quantum) ? quantum : rem_bt[curr];
-        t += exec_time;
-        rem_bt[curr] -= exec_time;
-        
-        // Add newly arrived processes to queue (arrived during this quantum)
-        while (next_arrival_idx < n && plist[sorted_idx[next_arrival_idx]].art <= t) {
-            int idx = sorted_idx[next_arrival_idx];
-            if (!in_queue[idx] && rem_bt[idx] > 0) {
-                queue[rear] = idx;
-                rear = (rear + 1) % n;
-                queue_size++;
-                in_queue[idx] = 1;
-            }
-            next_arrival_idx++;
+        for (int i = 0; i < k; i++) {
+            rewind(inputs[i]);
+            trace_open(&readers[i], inputs[i]);
         }
-        
-        // Check if current process is done
-        if (rem_bt[curr] == 0) {
-            completed++;
-            finish_time[curr] = t;
-            // Waiting time = finish time - burst time - arrival time
-            plist[curr].wt = finish_time[curr] - plist[curr].bt - plist[curr].art;
-            if (plist[curr].wt < 0) plist[curr].wt = 0;
+        merge_init(&merge, readers, k, true);
+        merge_source(&src, &merge);
+        engine_run(&e, &src, m);
+        if (merge.unsorted) {
+            printf("Error: Input %s is not sorted by arrival time\n", files[merge.unsorted - 1]);
+            status = 1;
+        } else if (merge.overflow) {
+            printf("Error: Input %s has pids too large to tag with their input\n",
+                   files[merge.overflow - 1]);
+            status = 1;
         } else {
-            // Put back in queue
-            queue[rear] = curr;
-            rear = (rear + 1) % n;
-            queue_size++;
+            printSummary(engine_policy_name(e.policy), m);
+            printOverheads(&e, m);
+            if (csv_file != NULL)
+                metrics_csv(csv_file, engine_policy_name(e.policy), m);
         }
+        merge_free(&merge);
+        if (budgetSpent(&e, m))
+            break;
     }
     
-    free(rem_bt);
-    free(finish_time);
-    free(in_queue);
-    free(queue);
-    free(sorted_idx);
-}
-
-// Function to calculate average time for FCFS
-void findavgTimeFCFS(ProcessType plist[], int n) {
-    findWaitingTimeFCFS(plist, n);
-    findTurnAroundTime(plist, n);
-    printf("\n*********\nFCFS\n");
-}
-
-// Function to calculate average time for Priority Scheduling
-void findavgTimePriority(ProcessType plist[], int n) {
-    qsort(plist, n, sizeof(ProcessType), my_comparer);
-    findWaitingTimeFCFS(plist, n);
-    findTurnAroundTime(plist, n);
-    printf("\n*********\nPriority\n");
-}
-
-// Function to calculate average time for SJF
-void findavgTimeSJF(ProcessType plist[], int n) {
-    findWaitingTimeSJF(plist, n);
-    findTurnAroundTime(plist, n);
-    printf("\n*********\nSJF\n");
+    for (int i = 0; i < k; i++) {
+        if (inputs[i] != NULL)
+            fclose(inputs[i]);
+    }
+    engine_work_free(&work);
+    free(inputs);
+    free(readers);
+    free(m);
+    return status;
 }
 
-// Function to calculate average time for Round Robin
-void findavgTimeRR(ProcessType plist[], int n, int quantum) {
-    findWaitingTimeRR(plist, n, quantum);
-    findTurnAroundTime(plist, n);
-    printf("\n*********\nRR Quantum = %d\n", quantum);
-}
+// Long-only options, numbered past any short option character
+enum { OPT_TIME_BUDGET = 256, OPT_PROGRESS };
 
-// Function to print metrics
-void printMetrics(ProcessType plist[], int n) {
-    int total_wt = 0, total_tat = 0;
-    float awt, att;
-    
-    printf("\tProcesses\tBurst time\tWaiting time\tTurn around time\n");
-    
-    for (int i = 0; i < n; i++) {
-        total_wt += plist[i].wt;
-        total_tat += plist[i].tat;
-        printf("\t%d\t\t%d\t\t%d\t\t%d\n", plist[i].pid, plist[i].bt, plist[i].wt, plist[i].tat);
-    }
-    
-    awt = ((float)total_wt / (float)n);
-    att = ((float)total_tat / (float)n);
-    
-    printf("\nAverage waiting time = %.2f", awt);
-    printf("\nAverage turn around time = %.2f\n", att);
-}
+static const struct option long_options[] = {
+    { "time-budget", required_argument, NULL, OPT_TIME_BUDGET },
+    { "progress", optional_argument, NULL, OPT_PROGRESS },
+    { NULL, 0, NULL, 0 }
+};
 
 int main(int argc, char *argv[]) {
     int n = 0;
-    int quantum = 2;
+    SimTimeType quantum = 2;
+    char *end;
+    int opt;
     ProcessType *plist = NULL;
     FILE *input_file = NULL;
+    const char *csv_path = NULL;
+    FILE *csv_file = NULL;
+    bool compare = false;
+    bool model = false, model_only = false;
+    bool bounds = false;
+    int cpus = 1;
+    bool engine = false;
+    int users = 0;
+    double think = 0;
+    long jobs = 0;
+    unsigned long long seed = 1;
+    long run_records = 0;
+    int threads = 1;
+    ForkTableType table = { NULL, 0 };
+    const ForkTableType *forks = NULL;
+    FILE *fork_file;
+    int bad_line;
+    HugeModeType huge;
+    ObjectiveType objectives[MAX_OBJECTIVES] = { OBJ_WT };
+    int num_objectives = 1;
+    double budget = 0, interval = 0;
+    ProgressType progress;
+    const char *noise_spec = NULL;
+    NoiseType noise;
+    DecisionCostType costs[NUM_POLICIES] = { { COST_FREE, 0 } };
+    bool costed = false;
+    AdmissionType admission;
+    bool bounded = false;
+    double hz;
+    SimTimeType tick = 0;
+    bool tickless = false;
+    
+    while ((opt = getopt_long(argc, argv, "c:CO:aAbm:eL:s:S:j:F:H:q:N:D:T:Q:", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'c':
+            // Machine readable metrics, one CSV row per policy and class
+            csv_path = optarg;
+            break;
+        case 'C':
+            compare = true;
+            break;
+        case 'O':
+            // Objectives for the comparison ranking, e.g. "wt,rt"
+            num_objectives = compare_parse_objectives(optarg, objectives, MAX_OBJECTIVES);
+            if (num_objectives <= 0) {
+                printf("Error: Unknown objective in %s (use wt, tat, rt, slowdown, p95rt, jain)\n", optarg);
+                return 1;
+            }
+            compare = true;
+            break;
+        case 'a':
+            // Analytical queueing estimates next to the simulated averages
+            model = true;
+            break;
+        case 'A':
+            // Analytical estimates only, skip the simulation
+            model = model_only = true;
+            break;
+        case 'b':
+            // Offline optimum and lower bounds, with each policy's gap
+            bounds = true;
+            break;
+        case 'm':
+            // CPU count for the multi-CPU lower bound
+            cpus = atoi(optarg);
+            if (cpus < 1) {
+                printf("Error: CPU count must be at least 1\n");
+                return 1;
+            }
+            bounds = true;
+            break;
+        case 'e':
+            // Replay the input through the online engine
+            engine = true;
+            break;
+        case 'L':
+            // Closed loop: users,mean think time,total jobs
+            if (sscanf(optarg, "%d,%lf,%ld", &users, &think, &jobs) != 3 || users < 1 || jobs < 1) {
+                printf("Error: Closed loop needs users,think,jobs\n");
+                return 1;
+            }
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'S':
+            // External sort with runs of this many processes
+            run_records = atol(optarg);
+            if (run_records < 1) {
+                printf("Error: Run size must be at least 1\n");
+                return 1;
+            }
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            if (threads < 1) {
+                printf("Error: Thread count must be at least 1\n");
+                return 1;
+            }
+            break;
+        case 'F':
+            // Processes forking children mid-burst, run through the engine
+            fork_file = fopen(optarg, "r");
+            if (fork_file == NULL) {
+                printf("Error: Could not open file %s\n", optarg);
+                return 1;
+            }
+            bad_line = fork_load(&table, fork_file);
+            fclose(fork_file);
+            if (bad_line != 0) {
+                printf("Error: Bad fork spec on line %d (malformed, forking an ancestor or\n"
+                       "       beyond the burst of its parent)\n", bad_line);
+                return 1;
+            }
+            forks = &table;
+            engine = true;
+            break;
+        case 'H':
+            // Huge pages for large tables: off, thp or explicit
+            if (mem_parse_huge(optarg, &huge) != 0) {
+                printf("Error: Unknown huge page mode %s (use off, thp, explicit)\n", optarg);
+                return 1;
+            }
+            mem_set_huge(huge);
+            break;
+        case 'N':
+            // OS noise stealing CPU time, run through the engine
+            noise_spec = optarg;
+            engine = true;
+            break;
+        case 'D':
+            // CPU time per scheduling decision, run through the engine
+            if (engine_parse_costs(optarg, costs) != 0) {
+                printf("Error: Bad decision cost %s (use [policy=]const|log|linear:a,...)\n", optarg);
+                return 1;
+            }
+            costed = engine = true;
+            break;
+        case 'Q':
+            // Bounded ready queue and load shedding, run through the engine
+            if (engine_parse_admission(optarg, &admission) != 0) {
+                printf("Error: Bad admission control %s (use capacity[,reject|oldest|lowpri|deadline:slack],\n"
+                       "       capacity 0 only with deadline)\n", optarg);
+                return 1;
+            }
+            bounded = engine = true;
+            break;
+        case 'T':
+            // Preempt on timer ticks at HZ, times being in nanoseconds;
+            // nohz: leaves the idle CPU without a tick
+            tickless = strncmp(optarg, "nohz:", 5) == 0;
+            hz = atof(tickless ? optarg + 5 : optarg);
+            tick = hz > 0 ? llround(1e9 / hz) : 0;
+            if (tick < 1) {
+                printf("Error: Bad tick rate %s (use [nohz:]HZ, at most 1e9)\n", optarg);
+                return 1;
+            }
+            engine = true;
+            break;
+        case 'q':
+            // RR time slice, in the trace's time unit
+            errno = 0;
+            quantum = strtoll(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || errno == ERANGE || quantum < 1) {
+                printf("Error: Quantum must be a whole number of at least 1\n");
+                return 1;
+            }
+            break;
+        case OPT_TIME_BUDGET:
+            // Wall-clock seconds; stops with partial statistics, run through the engine
+            budget = atof(optarg);
+            if (budget <= 0) {
+                printf("Error: Time budget must be positive\n");
+                return 1;
+            }
+            engine = true;
+            break;
+        case OPT_PROGRESS:
+            // Progress on stderr every so many seconds, run through the engine
+            interval = optarg != NULL ? atof(optarg) : 1.0;
+            if (interval <= 0) {
+                printf("Error: Progress interval must be positive\n");
+                return 1;
+            }
+            engine = true;
+            break;
+        default:
+            printf("Usage: %s [-c metrics.csv] [-C] [-O objectives] [-a|-A] [-b] [-m cpus]\n"
+                   "          [-e] [-L users,think,jobs] [-s seed] [-S run_size] [-j threads]\n"
+                   "          [-F fork_file] [-H off|thp|explicit] [-q quantum] [-N noise]\n"
+                   "          [-D decision_costs] [-T [nohz:]HZ] [-Q capacity[,shed_policy]]\n"
+                   "          [--time-budget=seconds] [--progress[=seconds]] [input_file ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    // These reports need every process's result in plist, which only
+    // the classic schedulers on a single trace produce
+    if ((compare || model || bounds) && (engine || users > 0 || run_records > 0 || argc - optind > 1)) {
+        printf("Error: -C, -O, -a, -A, -b and -m need the classic schedulers on a single trace;\n"
+               "       they do not combine with -e, -L, -S, several inputs or the engine options\n");
+        return 1;
+    }
+    // -A runs no scheduler, so there would be no metrics to write
+    if (model_only && csv_path != NULL) {
+        printf("Error: -c needs the simulation, which -A skips\n");
+        return 1;
+    }
+    if (csv_path != NULL) {
+        csv_file = fopen(csv_path, "w");
+        if (csv_file == NULL) {
+            printf("Error: Could not open file %s\n", csv_path);
+            return 1;
+        }
+    }
+
+    EngineType opts = { POLICY_FCFS, quantum, forks, NULL, NULL, NULL, costed ? costs : NULL,
+                        tick, tickless, bounded ? &admission : NULL };
+    if (noise_spec != NULL) {
+        // Seeded after every option is read, so -s may come later
+        bad_line = noise_init(&noise, noise_spec, seed);
+        if (bad_line < 0) {
+            printf("Error: Bad noise spec %s (use periodic:period,cost, poisson:mean_gap,cost\n"
+                   "       with cost below the gap, or replay:file)\n", noise_spec);
+            return 1;
+        }
+        if (bad_line > 0) {
+            printf("Error: Bad noise event on line %d\n", bad_line);
+            return 1;
+        }
+        opts.noise = &noise;
+    }
     
-    if (argc == 2) {
-        input_file = fopen(argv[1], "r");
+    // Several inputs are merged by arrival time, one tenant per file
+    if (argc - optind > 1) {
+        if (csv_file != NULL)
+            metrics_csv_header(csv_file);
+        opts.progress = startProgress(&progress, interval, budget);
+        int status = runMerged(&argv[optind], argc - optind, &opts, csv_file);
+        if (opts.progress != NULL)
+            progress_end(&progress);
+        if (csv_file != NULL)
+            fclose(csv_file);
+        fork_free(&table);
+        if (opts.noise != NULL)
+            noise_free(&noise);
+        return status;
+    }
+    
+    if (optind < argc) {
+        input_file = fopen(argv[optind], "r");
         if (input_file == NULL) {
-            printf("Error: Could not open file %s\n", argv[1]);
+            printf("Error: Could not open file %s\n", argv[optind]);
             return 1;
         }
-        plist = parse_file(input_file, &n);
-        fclose(input_file);
     } else {
         input_file = stdin;
-        plist = parse_file(input_file, &n);
+    }
+    
+    // Streamed straight from the input, never loaded into plist
+    if (run_records > 0) {
+        if (csv_file != NULL)
+            metrics_csv_header(csv_file);
+        opts.progress = startProgress(&progress, interval, budget);
+        int status = runExternalSort(input_file, run_records, threads, &opts, csv_file);
+        if (opts.progress != NULL)
+            progress_end(&progress);
+        if (input_file != stdin)
+            fclose(input_file);
+        if (csv_file != NULL)
+            fclose(csv_file);
+        fork_free(&table);
+        if (opts.noise != NULL)
+            noise_free(&noise);
+        return status;
+    }
+    
+    plist = parse_file(input_file, &n);
+    if (input_file != stdin) {
+        fclose(input_file);
     }
     
     if (plist == NULL || n == 0) {
@@ -285,11 +537,47 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    if (forks != NULL && (bad_line = fork_check(forks, plist, n)) != 0) {
+        printf("Error: Fork spec on line %d lies beyond the parent's burst\n", bad_line);
+        return 1;
+    }
+    if (engine || users > 0) {
+        if (csv_file != NULL)
+            metrics_csv_header(csv_file);
+        opts.progress = startProgress(&progress, interval, budget);
+        if (users > 0)
+            runClosedLoop(plist, n, &opts, users, think, jobs, seed, csv_file);
+        else
+            runEngine(plist, n, &opts, csv_file);
+        if (opts.progress != NULL)
+            progress_end(&progress);
+        if (csv_file != NULL)
+            fclose(csv_file);
+        fork_free(&table);
+        if (opts.noise != NULL)
+            noise_free(&noise);
+        mem_free(plist);
+        return 0;
+    }
+    
+    WorkloadFitType fit;
+    QueueModelType qmodel;
+    if (model) {
+        queue_fit(plist, n, &fit);
+        queue_model(plist, n, &fit, &qmodel);
+    }
+    if (model_only) {
+        queue_print(&fit, &qmodel, NULL, NULL, NULL);
+        mem_free(plist);
+        return 0;
+    }
+    
     // Create copies for each algorithm
-    ProcessType *plist_fcfs = (ProcessType *)malloc(n * sizeof(ProcessType));
-    ProcessType *plist_priority = (ProcessType *)malloc(n * sizeof(ProcessType));
-    ProcessType *plist_sjf = (ProcessType *)malloc(n * sizeof(ProcessType));
-    ProcessType *plist_rr = (ProcessType *)malloc(n * sizeof(ProcessType));
+    ProcessType *plist_fcfs = (ProcessType *)mem_alloc(n * sizeof(ProcessType));
+    ProcessType *plist_priority = (ProcessType *)mem_alloc(n * sizeof(ProcessType));
+    ProcessType *plist_sjf = (ProcessType *)mem_alloc(n * sizeof(ProcessType));
+    ProcessType *plist_rr = (ProcessType *)mem_alloc(n * sizeof(ProcessType));
+    int *order_priority = (int *)mem_alloc(n * sizeof(int));
     
     for (int i = 0; i < n; i++) {
         plist_fcfs[i] = plist[i];
@@ -298,23 +586,63 @@ int main(int argc, char *argv[]) {
         plist_rr[i] = plist[i];
     }
     
-    findavgTimeFCFS(plist_fcfs, n);
-    printMetrics(plist_fcfs, n);
+    MetricsType *m_fcfs = (MetricsType *)malloc(sizeof(MetricsType));
+    MetricsType *m_priority = (MetricsType *)malloc(sizeof(MetricsType));
+    MetricsType *m_sjf = (MetricsType *)malloc(sizeof(MetricsType));
+    MetricsType *m_rr = (MetricsType *)malloc(sizeof(MetricsType));
+    
+    findavgTimeFCFS(plist_fcfs, n, m_fcfs);
+    printMetrics(plist_fcfs, NULL, n, m_fcfs);
+    
+    findavgTimePriority(plist_priority, order_priority, n, m_priority);
+    printMetrics(plist_priority, order_priority, n, m_priority);
+    
+    findavgTimeSJF(plist_sjf, n, m_sjf);
+    printMetrics(plist_sjf, NULL, n, m_sjf);
     
-    findavgTimePriority(plist_priority, n);
-    printMetrics(plist_priority, n);
+    findavgTimeRR(plist_rr, n, quantum, m_rr);
+    printMetrics(plist_rr, NULL, n, m_rr);
     
-    findavgTimeSJF(plist_sjf, n);
-    printMetrics(plist_sjf, n);
+    PolicyResultType results[] = {
+        { "FCFS", plist_fcfs, m_fcfs },
+        { "Priority", plist_priority, m_priority },
+        { "SJF", plist_sjf, m_sjf },
+        { "RR", plist_rr, m_rr },
+    };
     
-    findavgTimeRR(plist_rr, n, quantum);
-    printMetrics(plist_rr, n);
+    if (compare) {
+        compare_policies(results, 4, n, objectives, num_objectives);
+    }
+    
+    if (model) {
+        queue_print(&fit, &qmodel, m_fcfs, m_rr, m_sjf);
+    }
+    
+    if (bounds) {
+        BoundsType b;
+        bounds_compute(plist, n, cpus, &b);
+        bounds_print(&b, results, 4);
+    }
+    
+    if (csv_file != NULL) {
+        metrics_csv_header(csv_file);
+        metrics_csv(csv_file, "FCFS", m_fcfs);
+        metrics_csv(csv_file, "Priority", m_priority);
+        metrics_csv(csv_file, "SJF", m_sjf);
+        metrics_csv(csv_file, "RR", m_rr);
+        fclose(csv_file);
+    }
     
-    free(plist);
-    free(plist_fcfs);
-    free(plist_priority);
-    free(plist_sjf);
-    free(plist_rr);
+    mem_free(plist);
+    mem_free(plist_fcfs);
+    mem_free(plist_priority);
+    mem_free(plist_sjf);
+    mem_free(plist_rr);
+    mem_free(order_priority);
+    free(m_fcfs);
+    free(m_priority);
+    free(m_sjf);
+    free(m_rr);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,473 @@
+#ifndef SCRIPT_HPP
+#define SCRIPT_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "metrics.h"
+#include "process.h"
+#include "rng.h"
+}
+
+/**
+ * Process behaviour written as C++20 coroutines. A script is a
+ * coroutine returning Script whose first parameter is the Sim; it
+ * describes one process as a sequence of
+ *   co_await compute(t)     run on the CPU for t
+ *   co_await io(t)          block off the CPU for t
+ *   co_await lock(z)        take mutex z, queueing FIFO if it is held
+ *   co_await unlock(z)      release z, handing it to the next waiter
+ *   co_await spawn(child)   start a child process now
+ *   co_await join()         block until every child has exited
+ * Sim resumes each script at its event times on one CPU, round robin
+ * among compute bursts.
+ *
+ * Coroutine frames and process records come from the Sim's Arena and
+ * go back to per-size free lists when a process exits, so once the
+ * arena has grown to the peak number of live processes nothing is
+ * allocated any more. Suspending never allocates: awaitables live in
+ * the frame and every queue is an intrusive list through the process.
+ */
+
+namespace sched {
+
+/**
+ * Bump allocator over 1 MB chunks with a free list per 16-byte size
+ * class. Blocks are only ever recycled into the same class, which fits
+ * a workload made of a few script types.
+ */
+class Arena {
+public:
+    static constexpr size_t ALIGN = 16;
+    static constexpr size_t CHUNK = 1 << 20;
+    static constexpr size_t MAX_BLOCK = CHUNK / 4;
+
+    Arena() : cur_(nullptr), end_(nullptr), free_(MAX_BLOCK / ALIGN + 1, nullptr), live_(0) {}
+    ~Arena() {
+        for (char *c : chunks_)
+            std::free(c);
+    }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *alloc(size_t size) {
+        size_t cls = (size + ALIGN - 1) / ALIGN;
+        if (cls >= free_.size())
+            std::abort();
+        live_++;
+        if (free_[cls] != nullptr) {
+            FreeNode *n = free_[cls];
+            free_[cls] = n->next;
+            return n;
+        }
+        if ((size_t) (end_ - cur_) < cls * ALIGN) {
+            cur_ = (char *) std::malloc(CHUNK);
+            if (cur_ == nullptr)
+                std::abort();
+            end_ = cur_ + CHUNK;
+            chunks_.push_back(cur_);
+        }
+        void *p = cur_;
+        cur_ += cls * ALIGN;
+        return p;
+    }
+    void free(void *p, size_t size) {
+        size_t cls = (size + ALIGN - 1) / ALIGN;
+        FreeNode *n = (FreeNode *) p;
+        n->next = free_[cls];
+        free_[cls] = n;
+        live_--;
+    }
+
+    size_t chunks() const { return chunks_.size(); }
+    long live() const { return live_; }
+
+private:
+    struct FreeNode {
+        FreeNode *next;
+    };
+    std::vector<char *> chunks_;
+    char *cur_, *end_;
+    std::vector<FreeNode *> free_;
+    long live_;
+};
+
+class Sim;
+
+struct Action {
+    enum Kind { NONE, COMPUTE, IO, LOCK, UNLOCK, SPAWN, JOIN } kind;
+    long amount;				// compute or I/O time, or lock number
+    void *child;				// SPAWN: frame address of the child
+};
+
+class Script {
+public:
+    struct promise_type {
+        Action action{ Action::NONE, 0, nullptr };
+
+        // The frame is prefixed with its arena so delete can find it
+        template <class... Args>
+        static void *operator new(size_t size, Sim &sim, Args &&...);
+        static void operator delete(void *p, size_t size) {
+            char *block = (char *) p - Arena::ALIGN;
+            Arena *arena;
+            std::memcpy(&arena, block, sizeof(arena));
+            arena->free(block, size + Arena::ALIGN);
+        }
+
+        Script get_return_object() { return Script(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Script() : h_(nullptr) {}
+    explicit Script(Handle h) : h_(h) {}
+    Script(Script &&o) noexcept : h_(std::exchange(o.h_, nullptr)) {}
+    Script &operator=(Script &&o) noexcept {
+        if (h_)
+            h_.destroy();
+        h_ = std::exchange(o.h_, nullptr);
+        return *this;
+    }
+    ~Script() {
+        if (h_)
+            h_.destroy();
+    }
+
+    explicit operator bool() const { return (bool) h_; }
+    Handle release() { return std::exchange(h_, nullptr); }
+
+private:
+    Handle h_;
+};
+
+// Hands its action to the engine and suspends; the engine resumes the
+// script once the action has completed
+struct Await {
+    Action action;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(Script::Handle h) noexcept { h.promise().action = action; }
+    void await_resume() const noexcept {}
+};
+
+inline Await compute(long t) { return Await{ { Action::COMPUTE, t, nullptr } }; }
+inline Await io(long t) { return Await{ { Action::IO, t, nullptr } }; }
+inline Await lock(int z) { return Await{ { Action::LOCK, z, nullptr } }; }
+inline Await unlock(int z) { return Await{ { Action::UNLOCK, z, nullptr } }; }
+inline Await join() { return Await{ { Action::JOIN, 0, nullptr } }; }
+inline Await spawn(Script child) { return Await{ { Action::SPAWN, 0, child.release().address() } }; }
+
+class Sim {
+public:
+    Sim(long quantum, int locks)
+        : quantum_(quantum), owner_(locks, nullptr), waiters_(locks), t_(0), next_pid_(1),
+          peak_live_(0), live_(0) {
+        rng_seed(&rng_, 1);
+    }
+
+    Arena &arena() { return arena_; }
+    RngType &rng() { return rng_; }
+    long now() const { return t_; }
+    long busy() const { return busy_; }
+    long peak_live() const { return peak_live_; }
+    long live() const { return live_; }		// left blocked after run()
+
+    /**
+     * Runs until src is exhausted and every process has exited or is
+     * stuck on a lock or join. src.next(sim, art, script, tenant)
+     * returns false when it has no more arrivals. Returns the time the
+     * last process exited. Frames of stuck processes are reclaimed
+     * with the arena.
+     */
+    template <class Source>
+    long run(Source &src, MetricsType *m);
+
+private:
+    struct Proc {
+        Script::Handle h;
+        ProcessType rec;		// bt accumulates CPU time, wt ready time
+        long rem;				// left of the current compute burst
+        long ready_at;
+        bool dispatched;
+        bool exited;
+        bool joining;
+        int children;			// live children
+        Proc *parent;
+        Proc *next;				// ready queue, lock waiters or resume list
+    };
+
+    // Intrusive FIFO of processes
+    struct List {
+        Proc *head = nullptr, *tail = nullptr;
+
+        bool empty() const { return head == nullptr; }
+        void push(Proc *p) {
+            p->next = nullptr;
+            if (tail)
+                tail->next = p;
+            else
+                head = p;
+            tail = p;
+        }
+        Proc *pop() {
+            Proc *p = head;
+            head = p->next;
+            if (head == nullptr)
+                tail = nullptr;
+            return p;
+        }
+    };
+
+    // Timer entries order by time, then by sequence so ties stay FIFO
+    struct Timer {
+        long at;
+        long seq;
+        Proc *p;
+        bool operator>(const Timer &o) const { return at != o.at ? at > o.at : seq > o.seq; }
+    };
+
+    Proc *create(Script::Handle h, long art, int tenant, Proc *parent) {
+        Proc *p = new (arena_.alloc(sizeof(Proc))) Proc();
+        p->h = h;
+        p->rec.pid = next_pid_++;
+        p->rec.art = art;
+        p->rec.tenant = tenant;
+        p->parent = parent;
+        if (++live_ > peak_live_)
+            peak_live_ = live_;
+        return p;
+    }
+
+    void release(Proc *p) {
+        p->h.destroy();
+        arena_.free(p, sizeof(Proc));
+        live_--;
+    }
+
+    void make_ready(Proc *p, long at) {
+        p->ready_at = at;
+        ready_.push(p);
+    }
+
+    void timer_push(long at, Proc *p) {
+        timers_.push_back(Timer{ at, seq_++, p });
+        size_t i = timers_.size() - 1;
+        while (i > 0 && timers_[(i - 1) / 2] > timers_[i]) {
+            std::swap(timers_[i], timers_[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+    }
+
+    Timer timer_pop() {
+        Timer top = timers_[0];
+        timers_[0] = timers_.back();
+        timers_.pop_back();
+        size_t i = 0, n = timers_.size();
+        for (;;) {
+            size_t c = 2 * i + 1;
+            if (c >= n)
+                break;
+            if (c + 1 < n && timers_[c] > timers_[c + 1])
+                c++;
+            if (!(timers_[i] > timers_[c]))
+                break;
+            std::swap(timers_[i], timers_[c]);
+            i = c;
+        }
+        return top;
+    }
+
+    void exit(Proc *p, MetricsType *m) {
+        p->rec.tat = ev_ - p->rec.art;
+        metrics_add(m, &p->rec);
+        p->exited = true;
+        last_exit_ = ev_;
+
+        Proc *parent = p->parent;
+        if (p->children == 0)
+            release(p);
+        if (parent != nullptr && --parent->children == 0) {
+            if (parent->joining) {
+                parent->joining = false;
+                resume_.push(parent);
+            } else if (parent->exited) {
+                release(parent);
+            }
+        }
+    }
+
+    // A script that names a lock that does not exist, or unlocks one
+    // it does not hold, is broken; stop rather than corrupt the locks
+    void check_lock(const Proc *p, const Action &a) {
+        if (a.amount < 0 || a.amount >= (long) owner_.size()) {
+            std::fprintf(stderr, "Error: Process %d uses lock %ld of %zu\n", p->rec.pid, a.amount,
+                         owner_.size());
+            std::abort();
+        }
+        if (a.kind == Action::UNLOCK && owner_[a.amount] != p) {
+            std::fprintf(stderr, "Error: Process %d unlocks lock %ld, which it does not hold\n",
+                         p->rec.pid, a.amount);
+            std::abort();
+        }
+    }
+
+    // Runs scripts on the resume list at event time ev_ until each
+    // blocks or exits
+    void drain(MetricsType *m) {
+        while (!resume_.empty()) {
+            Proc *p = resume_.pop();
+            for (;;) {
+                p->h.resume();
+                if (p->h.done()) {
+                    exit(p, m);
+                    break;
+                }
+                Action &a = p->h.promise().action;
+                if (a.kind == Action::COMPUTE && a.amount > 0) {
+                    p->rem = a.amount;
+                    make_ready(p, ev_);
+                    break;
+                }
+                if (a.kind == Action::IO && a.amount > 0) {
+                    timer_push(ev_ + a.amount, p);
+                    break;
+                }
+                if (a.kind == Action::LOCK || a.kind == Action::UNLOCK)
+                    check_lock(p, a);
+                if (a.kind == Action::LOCK) {
+                    if (owner_[a.amount] != nullptr) {
+                        waiters_[a.amount].push(p);
+                        break;
+                    }
+                    owner_[a.amount] = p;
+                } else if (a.kind == Action::UNLOCK) {
+                    List &w = waiters_[a.amount];
+                    owner_[a.amount] = w.empty() ? nullptr : w.pop();
+                    if (owner_[a.amount] != nullptr)
+                        resume_.push(owner_[a.amount]);
+                } else if (a.kind == Action::SPAWN) {
+                    Script::Handle h = Script::Handle::from_address(a.child);
+                    p->children++;
+                    resume_.push(create(h, ev_, p->rec.tenant, p));
+                } else if (a.kind == Action::JOIN && p->children > 0) {
+                    p->joining = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    Arena arena_;
+    RngType rng_;
+    long quantum_;
+    List ready_, resume_;
+    std::vector<Timer> timers_;
+    std::vector<Proc *> owner_;
+    std::vector<List> waiters_;
+    long t_;					// CPU clock
+    long ev_ = 0;				// time of the event being handled, <= t_
+    long seq_ = 0, last_exit_ = 0, busy_ = 0;
+    int next_pid_;
+    long peak_live_, live_;
+};
+
+template <class... Args>
+void *Script::promise_type::operator new(size_t size, Sim &sim, Args &&...)
+{
+    Arena *arena = &sim.arena();
+    char *block = (char *) arena->alloc(size + Arena::ALIGN);
+    std::memcpy(block, &arena, sizeof(arena));
+    return block + Arena::ALIGN;
+}
+
+template <class Source>
+long Sim::run(Source &src, MetricsType *m)
+{
+    long art = 0;
+    int tenant = 0;
+    Script next;
+    bool pending = src.next(*this, art, next, tenant);
+    Proc *requeue = nullptr;
+
+    metrics_init(m);
+    for (;;) {
+        // Idle CPU: jump to the next timer or arrival
+        if (requeue == nullptr && ready_.empty()) {
+            long wake = -1;
+            if (!timers_.empty())
+                wake = timers_[0].at;
+            if (pending && (wake < 0 || art < wake))
+                wake = art;
+            if (wake < 0)
+                break;
+            if (wake > t_)
+                t_ = wake;
+        }
+
+        // Arrivals, wakeups and ends of bursts due by now, in time order
+        for (;;) {
+            bool timer = !timers_.empty() && timers_[0].at <= t_;
+            bool arrival = pending && art <= t_;
+            if (!timer && !arrival)
+                break;
+            if (timer && (!arrival || timers_[0].at <= art)) {
+                Timer e = timer_pop();
+                ev_ = e.at;
+                resume_.push(e.p);
+            } else {
+                ev_ = art;
+                resume_.push(create(next.release(), art, tenant, nullptr));
+                pending = src.next(*this, art, next, tenant);
+            }
+            drain(m);
+        }
+        if (requeue != nullptr) {
+            ready_.push(requeue);
+            requeue = nullptr;
+        }
+        if (ready_.empty())
+            continue;
+
+        Proc *p = ready_.pop();
+        if (!p->dispatched) {
+            p->dispatched = true;
+            p->rec.rt = t_ - p->rec.art;
+        }
+        p->rec.wt += t_ - p->ready_at;
+
+        long slice = p->rem;
+        if (quantum_ > 0 && slice > quantum_)
+            slice = quantum_;
+        t_ += slice;
+        busy_ += slice;
+        p->rem -= slice;
+        p->rec.bt += slice;
+
+        // A finished burst resumes its script like any other event, so
+        // wakeups that came due during the slice are handled first
+        if (p->rem > 0) {
+            p->ready_at = t_;
+            requeue = p;
+        } else {
+            timer_push(t_, p);
+        }
+    }
+    return last_exit_;
+}
+
+}				// namespace sched
+
+#endif				// SCRIPT_HPP
@@ -0,0 +1,179 @@
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "script.hpp"
+
+extern "C" {
+#include "metrics.h"
+#include "rng.h"
+}
+
+/**
+ * Scripted workload driver. Processes arrive with exponential gaps and
+ * run one of the example scripts below; each script kind is reported
+ * as its own tenant.
+ */
+
+using sched::Script;
+using sched::Sim;
+
+enum ScriptKind { KIND_WEB, KIND_DB, KIND_BATCH, NUM_KINDS };
+
+static const char *kind_names[NUM_KINDS] = { "web", "db", "batch" };
+
+static long draw(Sim &sim, double mean)
+{
+    long t = std::lround(rng_exp(&sim.rng(), mean));
+    return t > 0 ? t : 1;
+}
+
+// Request handler: parse, read from disk, render
+static Script web(Sim &sim)
+{
+    co_await sched::compute(draw(sim, 2));
+    co_await sched::io(draw(sim, 20));
+    co_await sched::compute(draw(sim, 4));
+}
+
+// Transaction on one of locks rows, then a log write outside the lock
+static Script db(Sim &sim, int locks)
+{
+    int row = (int) (rng_next(&sim.rng()) % locks);
+
+    co_await sched::compute(1);
+    co_await sched::lock(row);
+    co_await sched::compute(draw(sim, 3));
+    co_await sched::unlock(row);
+    co_await sched::io(draw(sim, 10));
+}
+
+static Script worker(Sim &sim)
+{
+    co_await sched::compute(draw(sim, 8));
+    co_await sched::io(draw(sim, 5));
+    co_await sched::compute(draw(sim, 2));
+}
+
+// Fork-join batch job: split, run workers in parallel, merge
+static Script batch(Sim &sim, int fanout)
+{
+    co_await sched::compute(2);
+    for (int i = 0; i < fanout; i++)
+        co_await sched::spawn(worker(sim));
+    co_await sched::join();
+    co_await sched::compute(draw(sim, 3));
+}
+
+struct ScriptSource {
+    long count;
+    long issued;
+    double gap;
+    int kind;					// NUM_KINDS mixes all kinds
+    int locks;
+    int fanout;
+    long art;
+
+    bool next(Sim &sim, long &art_out, Script &script, int &tenant) {
+        if (issued == count)
+            return false;
+        if (issued++ > 0)
+            art += std::lround(rng_exp(&sim.rng(), gap));
+        tenant = kind < NUM_KINDS ? kind : (int) (rng_next(&sim.rng()) % NUM_KINDS);
+        switch (tenant) {
+        case KIND_WEB:
+            script = web(sim);
+            break;
+        case KIND_DB:
+            script = db(sim, locks);
+            break;
+        default:
+            script = batch(sim, fanout);
+            break;
+        }
+        art_out = art;
+        return true;
+    }
+};
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [-n processes] [-g mean_gap] [-q quantum] [-w web|db|batch|mix]\n"
+           "          [-l locks] [-f fanout] [-s seed]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    ScriptSource src = { 100000, 0, 25.0, NUM_KINDS, 8, 4, 0 };
+    long quantum = 2;
+    unsigned long long seed = 1;
+    char *rest;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:g:q:w:l:f:s:")) != -1) {
+        switch (opt) {
+        case 'n':
+            src.count = atol(optarg);
+            break;
+        case 'g':
+            src.gap = atof(optarg);
+            break;
+        case 'q':
+            errno = 0;
+            quantum = strtol(optarg, &rest, 10);
+            if (rest == optarg || *rest != '\0' || errno == ERANGE) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'w':
+            src.kind = NUM_KINDS;
+            for (int k = 0; k < NUM_KINDS; k++) {
+                if (strcmp(optarg, kind_names[k]) == 0)
+                    src.kind = k;
+            }
+            if (src.kind == NUM_KINDS && strcmp(optarg, "mix") != 0) {
+                printf("Error: Unknown workload %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'l':
+            src.locks = atoi(optarg);
+            break;
+        case 'f':
+            src.fanout = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (src.count < 1 || src.gap <= 0 || quantum < 0 || src.locks < 1 || src.fanout < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Sim sim(quantum, src.locks);
+    MetricsType *m = (MetricsType *) malloc(sizeof(MetricsType));
+    rng_seed(&sim.rng(), seed);
+
+    long end = sim.run(src, m);
+
+    printf("\n*********\nScripted RR Quantum = %ld\n", quantum);
+    printf("Processes = %ld\n", m->n);
+    printf("Average waiting time = %.2f", m->n ? (double) m->total_wt / m->n : 0.0);
+    printf("\nAverage turn around time = %.2f\n", m->n ? (double) m->total_tat / m->n : 0.0);
+    metrics_print(m);
+    printf("Finished at %ld, CPU busy %.1f%%\n", end, end > 0 ? 100.0 * sim.busy() / end : 0.0);
+    printf("Peak live processes = %ld, arena chunks = %zu\n", sim.peak_live(), sim.arena().chunks());
+    if (sim.live() > 0)
+        printf("Warning: %ld processes never finished\n", sim.live());
+
+    free(m);
+    return 0;
+}
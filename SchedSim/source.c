@@ -0,0 +1,104 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "source.h"
+#include "engine.h"
+#include "heap.h"
+#include "process.h"
+#include "rng.h"
+#include "workload.h"
+
+static bool array_peek(SourceType *src, ProcessType *p)
+{
+    ArraySourceType *a = (ArraySourceType *) src->state;
+
+    if (a->next >= a->n)
+        return false;
+    *p = a->plist[a->order ? a->order[a->next] : a->next];
+    return true;
+}
+
+static void array_pop(SourceType *src)
+{
+    ((ArraySourceType *) src->state)->next++;
+}
+
+void array_source_init(SourceType *src, ArraySourceType *a,
+                       const ProcessType plist[], const int order[], int n)
+{
+    a->plist = plist;
+    a->order = order;
+    a->n = n;
+    a->next = 0;
+    src->peek = array_peek;
+    src->pop = array_pop;
+    src->complete = NULL;
+    src->state = a;
+}
+
+// Draws the next job of user u and schedules its submission at t + think
+static void user_think(ClosedLoopType *c, int u, SimTimeType t)
+{
+    c->next_bt[u] = dist_sample(&c->model->burst, &c->rng, NULL);
+    c->next_pri[u] = dist_sample(&c->model->pri, &c->rng, NULL);
+    heap_push(&c->thinking, t + lround(rng_exp(&c->rng, c->think)), u);
+}
+
+static bool closed_peek(SourceType *src, ProcessType *p)
+{
+    ClosedLoopType *c = (ClosedLoopType *) src->state;
+
+    if (c->issued >= c->jobs || c->thinking.size == 0)
+        return false;
+
+    int u = c->thinking.nodes[0].idx;
+    memset(p, 0, sizeof(*p));
+    p->pid = (int) (c->issued + 1);
+    p->art = c->thinking.nodes[0].key;
+    p->bt = c->next_bt[u];
+    p->pri = c->next_pri[u];
+    p->tenant = u;
+    return true;
+}
+
+static void closed_pop(SourceType *src)
+{
+    ClosedLoopType *c = (ClosedLoopType *) src->state;
+
+    heap_pop(&c->thinking);
+    c->issued++;
+}
+
+static void closed_complete(SourceType *src, const ProcessType *p, SimTimeType finish)
+{
+    user_think((ClosedLoopType *) src->state, p->tenant, finish);
+}
+
+void closed_loop_init(SourceType *src, ClosedLoopType *c, int users, double think,
+                      long jobs, const WorkloadModelType *model, uint64_t seed)
+{
+    c->users = users;
+    c->think = think;
+    c->jobs = jobs;
+    c->issued = 0;
+    c->model = model;
+    rng_seed(&c->rng, seed);
+    heap_init(&c->thinking, users);
+    c->next_bt = (SimTimeType *) malloc(users * sizeof(SimTimeType));
+    c->next_pri = (int *) malloc(users * sizeof(int));
+    for (int u = 0; u < users; u++)
+        user_think(c, u, 0);
+
+    src->peek = closed_peek;
+    src->pop = closed_pop;
+    src->complete = closed_complete;
+    src->state = c;
+}
+
+void closed_loop_free(ClosedLoopType *c)
+{
+    heap_free(&c->thinking);
+    free(c->next_bt);
+    free(c->next_pri);
+}
@@ -0,0 +1,48 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdint.h>
+#include "engine.h"
+#include "heap.h"
+#include "process.h"
+#include "rng.h"
+#include "workload.h"
+
+/**
+ * Arrival sources for the engine
+ */
+
+// Replays an in-memory process list in the given arrival order
+typedef struct ArraySource {
+    const ProcessType *plist;
+    const int *order;
+    int n;
+    int next;
+} ArraySourceType;
+
+void array_source_init(SourceType *, ArraySourceType *, const ProcessType[], const int[], int);
+
+/**
+ * Closed-loop workload: each of users users submits a job, waits for
+ * it to finish, thinks for an exponential time and submits again, until
+ * jobs jobs have been issued. Arrivals are created on completion, so
+ * memory is O(users) however many jobs run. Service times and
+ * priorities are drawn from a fitted workload model.
+ */
+typedef struct ClosedLoop {
+    int users;
+    double think;		// mean think time
+    long jobs;
+    long issued;
+    const WorkloadModelType *model;
+    RngType rng;
+    HeapType thinking;	// next submit time per user
+    SimTimeType *next_bt;
+    int *next_pri;
+} ClosedLoopType;
+
+void closed_loop_init(SourceType *, ClosedLoopType *, int, double, long,
+                      const WorkloadModelType *, uint64_t);
+void closed_loop_free(ClosedLoopType *);
+
+#endif				// SOURCE_H
@@ -3,25 +3,100 @@
 #include<unistd.h>
 #include<stdlib.h>
 #include<errno.h>
+#include<string.h>
 
 #include "util.h"
+#include "mem.h"
 #include "process.h"
+#include "radix.h"
+
+static int known_header(const TraceHeaderType * hdr)
+{
+	return memcmp(hdr->magic, TRACE_MAGIC, 4) == 0 && hdr->version >= 1 && hdr->version <= TRACE_VERSION;
+}
+
+/**
+ * Reads one binary record of the given version into p, which must be
+ * zeroed. Returns 1 on success, 0 at the end.
+ */
+static int read_record(FILE * f, uint32_t version, ProcessType * p)
+{
+	if (version == 1) {
+		TraceRecordV1Type rec;
+
+		if (fread(&rec, sizeof(rec), 1, f) != 1)
+			return 0;
+		p->pid = rec.pid;
+		p->bt = rec.bt;
+		p->art = rec.art;
+		p->wt = rec.wt;
+		p->tat = rec.tat;
+		p->pri = rec.pri;
+	} else {
+		TraceRecordType rec;
+
+		if (fread(&rec, sizeof(rec), 1, f) != 1)
+			return 0;
+		p->pid = rec.pid;
+		p->bt = rec.bt;
+		p->art = rec.art;
+		p->wt = rec.wt;
+		p->tat = rec.tat;
+		p->pri = rec.pri;
+	}
+	return 1;
+}
+
+/**
+ * Reads a binary trace whose header has already been consumed
+ */
+static ProcessType *parse_binary(FILE * f, const TraceHeaderType * hdr, int *P_SIZE)
+{
+	// Zeroed, as read_record() expects
+	ProcessType *pptr = (ProcessType *) mem_alloc(hdr->count * sizeof(ProcessType));
+
+	for (uint64_t i = 0; i < hdr->count; i++) {
+		if (!read_record(f, hdr->version, &pptr[i]))
+			break;
+		*P_SIZE += 1;
+	}
+	return pptr;
+}
+
+/**
+ * Fills rec, in the current binary format, from p
+ */
+void trace_record(TraceRecordType * rec, const ProcessType * p)
+{
+	rec->pid = p->pid;
+	rec->pri = p->pri;
+	rec->bt = p->bt;
+	rec->art = p->art;
+	rec->wt = p->wt;
+	rec->tat = p->tat;
+}
 
 /**
  * Returns an array of process that are parsed from
  * the input file descriptor passed as argument
+ * Both the text format and the binary trace format are accepted
  * CAUTION: You need to free up the space that is allocated
- * by this function
+ * by this function, with mem_free()
  */
 ProcessType *parse_file(FILE * f, int *P_SIZE)
 {
 	int i = 0;
+	TraceHeaderType hdr;
+
+	if (fread(&hdr, sizeof(hdr), 1, f) == 1 && known_header(&hdr))
+		return parse_binary(f, &hdr, P_SIZE);
+	fseek(f, 0, SEEK_SET);
 
   ProcessType *pptr = (ProcessType *) malloc(sizeof(ProcessType));
   
   // count the number of processes
   while (!feof(f)) {
-		fscanf(f, "%d %d %d %d %d %d\n", &(pptr->pid), &(pptr->bt), &(pptr->art), &(pptr->wt), &(pptr->tat), &(pptr->pri));
+		fscanf(f, "%d %" SCNdTIME " %" SCNdTIME " %" SCNdTIME " %" SCNdTIME " %d\n", &(pptr->pid), &(pptr->bt), &(pptr->art), &(pptr->wt), &(pptr->tat), &(pptr->pri));
     *P_SIZE += 1;
 	}
 
@@ -29,11 +104,64 @@ ProcessType *parse_file(FILE * f, int *P_SIZE)
   fseek(f, 0, SEEK_SET);  // reset file pointer to beginning of fils
   
 	// read all the data
-	pptr = (ProcessType *) calloc(*P_SIZE, sizeof(ProcessType));
+	pptr = (ProcessType *) mem_alloc(*P_SIZE * sizeof(ProcessType));
 	while (!feof(f)) {
-		fscanf(f, "%d %d %d %d %d %d\n", &(pptr[i].pid), &(pptr[i].bt), &(pptr[i].art), &(pptr[i].wt), &(pptr[i].tat), &(pptr[i].pri));
+		fscanf(f, "%d %" SCNdTIME " %" SCNdTIME " %" SCNdTIME " %" SCNdTIME " %d\n", &(pptr[i].pid), &(pptr[i].bt), &(pptr[i].art), &(pptr[i].wt), &(pptr[i].tat), &(pptr[i].pri));
 		i++;
 	}
 
 	return pptr;
-}
\ No newline at end of file
+}
+
+/**
+ * Prepares r to stream f. A binary trace starts with the magic, which
+ * no text trace does, so one character of lookahead tells them apart.
+ */
+void trace_open(TraceReaderType * r, FILE * f)
+{
+	TraceHeaderType hdr;
+	int c = getc(f);
+
+	r->f = f;
+	r->binary = 0;
+	r->remaining = 0;
+	if (c == EOF)
+		return;
+	ungetc(c, f);
+	if (c == TRACE_MAGIC[0] && fread(&hdr, sizeof(hdr), 1, f) == 1 && known_header(&hdr)) {
+		r->binary = (int) hdr.version;
+		r->remaining = hdr.count;
+	}
+}
+
+/**
+ * Reads the next process into p. Returns 1 on success, 0 at the end
+ */
+int trace_read(TraceReaderType * r, ProcessType * p)
+{
+	memset(p, 0, sizeof(*p));
+	if (r->binary) {
+		if (r->remaining == 0 || !read_record(r->f, (uint32_t) r->binary, p))
+			return 0;
+		r->remaining--;
+		return 1;
+	}
+
+	return fscanf(r->f, "%d %" SCNdTIME " %" SCNdTIME " %" SCNdTIME " %" SCNdTIME " %d", &(p->pid), &(p->bt), &(p->art), &(p->wt), &(p->tat), &(p->pri)) == 6;
+}
+
+/**
+ * Fills order with the indices of plist sorted by arrival time,
+ * ties keep input order
+ */
+void sort_by_arrival(const ProcessType * plist, int n, int *order)
+{
+	uint64_t *keys = (uint64_t *) mem_alloc(n * sizeof(uint64_t));
+
+	for (int i = 0; i < n; i++) {
+		keys[i] = RADIX_KEY(plist[i].art);
+		order[i] = i;
+	}
+	radix_sort_index(keys, order, n, 0);
+	mem_free(keys);
+}
@@ -1,12 +1,50 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <stdint.h>
 #include "process.h"
 
 /**
  * Utility function file
  */
 
+/**
+ * Binary trace format: a TraceHeader followed by count TraceRecords in
+ * host byte order, columns as in the text format. Version 2 widened the
+ * times to 64 bits; version 1 traces are still read.
+ */
+#define TRACE_MAGIC "SSIM"
+#define TRACE_VERSION 2
+
+typedef struct TraceHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t count;
+} TraceHeaderType;
+
+typedef struct TraceRecord {
+	int32_t pid, pri;
+	int64_t bt, art, wt, tat;
+} TraceRecordType;
+
+typedef struct TraceRecordV1 {
+	int32_t pid, bt, art, wt, tat, pri;
+} TraceRecordV1Type;
+
+/**
+ * Record-at-a-time reader for either trace format, for inputs that are
+ * streamed rather than loaded with parse_file. Works on pipes.
+ */
+typedef struct TraceReader {
+	FILE *f;
+	int binary;		// 0 for text, else the binary version
+	uint64_t remaining;	// binary records left
+} TraceReaderType;
+
 ProcessType *parse_file(FILE *, int *);
+void trace_record(TraceRecordType *, const ProcessType *);
+void trace_open(TraceReaderType *, FILE *);
+int trace_read(TraceReaderType *, ProcessType *);
+void sort_by_arrival(const ProcessType *, int, int *);
 
 #endif				// UTIL_H
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "workload.h"
+#include "process.h"
+#include "rng.h"
+#include "util.h"
+
+static const char *dist_names[] = {
+    "empirical", "exp", "lognormal", "pareto", "mmpp",
+};
+
+int dist_kind(const char *name, DistKindType *kind)
+{
+    for (int k = 0; k < (int) (sizeof(dist_names) / sizeof(dist_names[0])); k++) {
+        if (strcmp(name, dist_names[k]) == 0) {
+            *kind = (DistKindType) k;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Fits a two-state MMPP to a gap sequence. Gaps at or below the median
+ * are attributed to the busy state and the rest to the calm state; the
+ * per-state mean gaps and the state switching probabilities are then
+ * counted directly from that labelling.
+ */
+static void fit_mmpp(DistType *d, const SimTimeType *x, long n)
+{
+    double *sorted = (double *) malloc(n * sizeof(double));
+    double sum[2] = { 0, 0 };
+    long count[2] = { 0, 0 }, leave[2] = { 0, 0 }, from[2] = { 0, 0 };
+    double median;
+    int prev = -1;
+
+    for (long i = 0; i < n; i++)
+        sorted[i] = x[i];
+    qsort(sorted, n, sizeof(double), cmp_double);
+    median = sorted[n / 2];
+    free(sorted);
+
+    for (long i = 0; i < n; i++) {
+        int s = x[i] <= median ? 0 : 1;
+        sum[s] += x[i];
+        count[s]++;
+        if (prev >= 0) {
+            from[prev]++;
+            if (s != prev)
+                leave[prev]++;
+        }
+        prev = s;
+    }
+
+    for (int s = 0; s < 2; s++) {
+        d->state_mean[s] = count[s] ? sum[s] / count[s] : sum[0] / count[0];
+        d->p_switch[s] = from[s] ? (double) leave[s] / from[s] : 0.0;
+    }
+}
+
+/**
+ * Fits kind to n non-negative integer samples. Parametric fits are
+ * maximum likelihood on the positive samples; zeros go to p_zero.
+ */
+void dist_fit(DistType *d, DistKindType kind, const SimTimeType *x, long n)
+{
+    long pos = 0;
+    double sum = 0, sum_log = 0, sum_log2 = 0, min = 0;
+
+    memset(d, 0, sizeof(*d));
+    d->kind = kind;
+    if (n <= 0)
+        return;
+
+    if (kind == DIST_EMPIRICAL) {
+        d->values = (SimTimeType *) malloc(n * sizeof(SimTimeType));
+        memcpy(d->values, x, n * sizeof(SimTimeType));
+        d->count = n;
+        return;
+    }
+    if (kind == DIST_MMPP) {
+        fit_mmpp(d, x, n);
+        return;
+    }
+
+    for (long i = 0; i < n; i++) {
+        if (x[i] <= 0)
+            continue;
+        double l = log(x[i]);
+        if (pos == 0 || x[i] < min)
+            min = x[i];
+        pos++;
+        sum += x[i];
+        sum_log += l;
+        sum_log2 += l * l;
+    }
+    d->p_zero = (double) (n - pos) / n;
+    if (pos == 0)
+        return;
+
+    d->mean = sum / pos;
+    d->mu = sum_log / pos;
+    d->sigma = sqrt(fmax(sum_log2 / pos - d->mu * d->mu, 0));
+    d->xm = min;
+    // alpha = pos / sum ln(x / xm), infinite when all samples are equal
+    double excess = sum_log - pos * log(min);
+    d->alpha = excess > 0 ? pos / excess : INFINITY;
+}
+
+void dist_free(DistType *d)
+{
+    free(d->values);
+    d->values = NULL;
+}
+
+static SimTimeType round_sample(double v, SimTimeType floor)
+{
+    // INT64_MAX is not exact as a double; stay below it
+    if (!(v < 9.2e18))
+        return INT64_MAX;
+    SimTimeType r = llround(v);
+    return r < floor ? floor : r;
+}
+
+/**
+ * The MMPP gap and phase draws apart, for callers that run the phase
+ * chain on its own stream: dist_sample_in() draws a gap in state and
+ * dist_step() returns the state after that arrival.
+ */
+SimTimeType dist_sample_in(const DistType *d, RngType *r, int state)
+{
+    return round_sample(rng_exp(r, d->state_mean[state]), 0);
+}
+
+int dist_step(const DistType *d, RngType *r, int state)
+{
+    return rng_uniform(r) < d->p_switch[state] ? 1 - state : state;
+}
+
+/**
+ * Draws one integer sample. state carries the MMPP state between calls
+ * on the same stream and is ignored by the other kinds.
+ */
+SimTimeType dist_sample(const DistType *d, RngType *r, int *state)
+{
+    switch (d->kind) {
+    case DIST_EMPIRICAL:
+        return d->count ? d->values[rng_next(r) % d->count] : 0;
+    case DIST_MMPP: {
+        SimTimeType gap = dist_sample_in(d, r, *state);
+        *state = dist_step(d, r, *state);
+        return gap;
+    }
+    default:
+        break;
+    }
+
+    if (rng_uniform(r) < d->p_zero || d->xm == 0)
+        return 0;
+    switch (d->kind) {
+    case DIST_EXP:
+        return round_sample(rng_exp(r, d->mean), 1);
+    case DIST_LOGNORMAL:
+        return round_sample(exp(d->mu + d->sigma * rng_normal(r)), 1);
+    case DIST_PARETO:
+        if (isinf(d->alpha))
+            return round_sample(d->xm, 1);
+        return round_sample(d->xm * pow(rng_uniform(r), -1 / d->alpha), 1);
+    default:
+        return 0;
+    }
+}
+
+void dist_print(FILE *f, const char *what, const DistType *d)
+{
+    fprintf(f, "%s: %s", what, dist_names[d->kind]);
+    switch (d->kind) {
+    case DIST_EMPIRICAL:
+        fprintf(f, " (%ld samples)", d->count);
+        break;
+    case DIST_EXP:
+        fprintf(f, " mean=%.3f", d->mean);
+        break;
+    case DIST_LOGNORMAL:
+        fprintf(f, " mu=%.3f sigma=%.3f", d->mu, d->sigma);
+        break;
+    case DIST_PARETO:
+        fprintf(f, " xm=%.3f alpha=%.3f", d->xm, d->alpha);
+        break;
+    case DIST_MMPP:
+        fprintf(f, " busy mean=%.3f leave=%.3f, calm mean=%.3f leave=%.3f",
+                d->state_mean[0], d->p_switch[0], d->state_mean[1], d->p_switch[1]);
+        break;
+    }
+    if (d->p_zero > 0)
+        fprintf(f, " p_zero=%.3f", d->p_zero);
+    fprintf(f, "\n");
+}
+
+/**
+ * Fits burst, inter-arrival and priority distributions of a trace.
+ * Gaps are taken between consecutive arrivals in arrival order.
+ */
+void workload_fit(WorkloadModelType *w, const ProcessType plist[], int n,
+                  DistKindType burst_kind, DistKindType gap_kind)
+{
+    int *order = (int *) malloc(n * sizeof(int));
+    SimTimeType *x = (SimTimeType *) calloc(n, sizeof(SimTimeType));
+
+    for (int i = 0; i < n; i++)
+        x[i] = plist[i].bt;
+    dist_fit(&w->burst, burst_kind, x, n);
+
+    for (int i = 0; i < n; i++)
+        x[i] = plist[i].pri;
+    dist_fit(&w->pri, DIST_EMPIRICAL, x, n);
+
+    sort_by_arrival(plist, n, order);
+    for (int i = 1; i < n; i++)
+        x[i - 1] = plist[order[i]].art - plist[order[i - 1]].art;
+    dist_fit(&w->gap, gap_kind, x, n - 1);
+
+    free(order);
+    free(x);
+}
+
+void workload_free(WorkloadModelType *w)
+{
+    dist_free(&w->burst);
+    dist_free(&w->gap);
+    dist_free(&w->pri);
+}
@@ -0,0 +1,52 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include "process.h"
+#include "rng.h"
+
+/**
+ * Distributions fitted to a trace and sampled to synthesize workloads.
+ * Integer traces often contain zeros (batch arrivals), which lognormal
+ * and Pareto cannot produce, so every distribution carries an atom at
+ * zero with probability p_zero and is fitted to the positive values.
+ */
+
+typedef enum DistKind {
+    DIST_EMPIRICAL,		// resample the trace values (empirical CDF)
+    DIST_EXP,
+    DIST_LOGNORMAL,
+    DIST_PARETO,
+    DIST_MMPP,			// two-state Markov modulated arrivals, gaps only
+} DistKindType;
+
+typedef struct Dist {
+    DistKindType kind;
+    double p_zero;
+    double mean;		// exponential
+    double mu, sigma;	// lognormal, of ln(x)
+    double xm, alpha;	// Pareto scale and shape
+    double state_mean[2];	// MMPP: mean gap in the busy (0) and calm (1) state
+    double p_switch[2];	// MMPP: probability of leaving each state after an arrival
+    SimTimeType *values;	// empirical samples
+    long count;
+} DistType;
+
+typedef struct WorkloadModel {
+    DistType burst;
+    DistType gap;
+    DistType pri;		// always empirical
+} WorkloadModelType;
+
+int dist_kind(const char *, DistKindType *);
+void dist_fit(DistType *, DistKindType, const SimTimeType *, long);
+void dist_free(DistType *);
+SimTimeType dist_sample(const DistType *, RngType *, int *);
+SimTimeType dist_sample_in(const DistType *, RngType *, int);
+int dist_step(const DistType *, RngType *, int);
+void dist_print(FILE *, const char *, const DistType *);
+
+void workload_fit(WorkloadModelType *, const ProcessType[], int, DistKindType, DistKindType);
+void workload_free(WorkloadModelType *);
+
+#endif				// WORKLOAD_H